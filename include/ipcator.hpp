@@ -34,8 +34,8 @@
  * @warning 要构建 release 版本, 请在文件范围内定义以下宏, 否则性能会非常差:
  *          - `NDEBUG`: 删除诸多非必要的校验措施;
  *          - `IPCATOR_OFAST`: 开启额外优化.  可能会导致观测到 API 的行为发生变化, 但此类
- *            变化通常无关紧要 (例如, 不判断 allocation 的 alignment 参数是否能被满足, 因为
- *            基本不可能不满足).
+ *            变化通常无关紧要 (例如, 以 `PROT_EXEC` 映射 `/dev/shm` 中的共享内存失败一次
+ *            之后, 就不再对它们尝试).
  * @note 定义 `IPCATOR_LOG` 宏可以打开日志.  调试用.
  * @note 定义 `IPCATOR_NAMESPACE` 宏可以将该文件内的所有 API 放到指定的命名空间.
  */
@@ -44,14 +44,16 @@
 #pragma once
 #include <version>
 #include <algorithm>  // ranges::fold_left
+#include <array>
 # if __has_include(<experimental/algorithm>)
 #   include <experimental/algorithm>  // experimental::sample
 # endif
-#include <atomic>  // atomic_uint, memory_order_relaxed
+#include <atomic>  // atomic{,_uint}, memory_order_{relaxed,acquire,release}
+#include <bit>  // bit_ceil, has_single_bit, popcount, countr_one
 #include <cassert>
-#include <cerrno>  // EPERM, errno
+#include <cerrno>  // EPERM, ETIMEDOUT, ENOTSUP, errno
 #include <chrono>
-#include <climits>  // NAME_MAX
+#include <climits>  // NAME_MAX, PATH_MAX, INT_MAX
 #include <concepts>  // {,unsigned_}integral, convertible_to, copy_constructible, same_as, movable
 #include <cstddef>  // size_t
 # if __has_include(<format>)
@@ -79,15 +81,21 @@
 # else
 #   error "你需要首先升级编译器和标准库以获得完整的 C++20 支持, 或安装 C++20 <format> 的替代品 <https://github.com/fmtlib/fmt>"
 # endif
-#include <cstdint>  // uintptr_t
+#include <cstdint>  // uintptr_t, uint{32,64}_t
+#include <cstdio>  // rename
+#include <cstring>  // memcpy
 #include <filesystem>  // filesystem::filesystem_error
 #include <functional>  // bind{_back,}, bit_or, plus
-#include <future>  // async, future_status::ready
+#include <future>  // async, future{,_status::ready}
 #include <iostream>  // clog
 #include <iterator>  // size, {,c}{begin,end}, data, empty, back_inserter
+#include <limits>  // numeric_limits
 #include <memory>  // shared_ptr
 #include <memory_resource>  // pmr::{memory_resource,monotonic_buffer_resource,{,un}synchronized_pool_resource,pool_options}
+#include <mutex>  // adopt_lock{,_t}
 #include <new>  // bad_alloc
+#include <numeric>  // iota
+#include <optional>
 #include <ostream>  // ostream
 #include <ranges>  // ranges::find_if, views::{chunk,transform,join_with,iota}
 #include <set>
@@ -113,7 +121,7 @@
 #include <stdexcept>  // invalid_argument
 #include <string>
 #include <string_view>
-#include <system_error>  // make_error_code, errc::no_such_file_or_directory
+#include <system_error>  // system_error, make_error_code, errc::{no_such_file_or_directory,operation_not_permitted}
 #include <thread>  // this_thread::{sleep_for,yield}
 #include <tuple>  // ignore
 #include <type_traits>  // conditional_t, is_const{_v,}, remove_reference{_t,}, is_same_v, decay_t, disjunction, is_lvalue_reference
@@ -131,10 +139,18 @@
     }
 # endif
 #include <variant>  // monostate
-#include <fcntl.h>  // O_{CREAT,RDWR,RDONLY,EXCL}, open
-#include <sys/mman.h>  // m{,un}map, shm_{open,unlink}, PROT_{WRITE,READ,EXEC}, MAP_{SHARED,FAILED,NORESERVE}
+#include <vector>
+#include <fcntl.h>  // O_{CREAT,RDWR,RDONLY,EXCL,CLOEXEC}, open, sync_file_range, readahead, posix_fadvise
+#include <sys/mman.h>  // m{,un}map, madvise, msync, shm_{open,unlink}, PROT_{WRITE,READ,EXEC}, MAP_{SHARED,FAILED,NORESERVE}
 #include <sys/stat.h>  // fstat, struct stat, fchmod
-#include <unistd.h>  // close, ftruncate, getpagesize
+#include <unistd.h>  // close, ftruncate, getpagesize, unlink, pread, write, access, syscall
+# ifdef __linux__
+#   include <linux/futex.h>  // FUTEX_{WAIT,WAKE}
+#   include <sys/syscall.h>  // SYS_futex
+# endif
+# ifdef __x86_64__
+#   include <immintrin.h>  // _mm{,256,512}_{loadu,stream}_si{128,256,512}, _mm_sfence
+# endif
 
 
 #ifdef __clang__
@@ -194,6 +210,41 @@ namespace POSIX {
 #endif
         return ::close(*fd);
     }
+
+    /**
+     * @brief 判断名字是否是普通文件 (位于 tmpfs, ext4, xfs 等文件系统上) 的路径.
+     * @details POSIX shared memory 的名字形如 `/name`, 除了开头之外不含 ‘/’.
+     *          因此, 除了开头之外还含有 ‘/’ 的名字, 都被视为普通文件的路径.
+     */
+    inline auto is_file_path [[gnu::pure]] (const std::string_view name) noexcept {
+        return name.find('/', 1) != name.npos;
+    }
+
+    /* 根据 `name` 的形式, 打开 POSIX shared memory 或普通文件. */
+    inline auto shm_open(const std::string& name, const int oflag, const ::mode_t mode) noexcept {
+        return is_file_path(name) ? ::open(name.c_str(), oflag, mode)
+                                  : ::shm_open(name.c_str(), oflag, mode);
+    }
+
+    /* 根据 `name` 的形式, 删除 POSIX shared memory 或普通文件. */
+    inline auto shm_unlink(const std::string& name) noexcept {
+        return is_file_path(name) ? ::unlink(name.c_str())
+                                  : ::shm_unlink(name.c_str());
+    }
+
+    /* 根据名字的形式, 原子地将 POSIX shared memory 或普通文件改名 (覆盖 `to`). */
+    inline auto shm_rename(const std::string& from, const std::string& to) noexcept {
+        if (is_file_path(from) || is_file_path(to))
+            return std::rename(from.c_str(), to.c_str());
+#ifdef __linux__
+        return std::rename(("/dev/shm" + from).c_str(), ("/dev/shm" + to).c_str());
+#elif defined __FreeBSD__ && __FreeBSD_version >= 1300000
+        return ::shm_rename(from.c_str(), to.c_str(), 0);
+#else
+        errno = ENOTSUP;
+        return -1;
+#endif
+    }
 }
 
 
@@ -214,6 +265,139 @@ inline namespace utils {
         const bool need_one_more_page = min_length % ::getpagesize();
         return (current_num_pages + need_one_more_page) * ::getpagesize();
     }
+
+    /**
+     * @brief 缓存行的大小, 即两个对象之间为了避免 false sharing 所需的最小间隔.
+     * @details 它决定了 shared memory 中各结构的布局, 是跨进程的 ABI, 因此只取决于目标
+     *          架构, 而不用 `std::hardware_destructive_interference_size` (它随 `-mtune`
+     *          等编译选项变化, 以不同选项编译的程序会对同一块共享内存算出不同的偏移量).
+     */
+    inline constexpr std::size_t cache_line_size =
+#if defined __aarch64__ && defined __APPLE__ || defined __powerpc64__
+        128
+#elif defined __s390x__
+        256
+#else
+        64
+#endif
+    ;
+
+    /**
+     * @brief 将数字向上取整, 成为缓存行大小的整数倍.
+     * @note example:
+     * ```
+     * assert( ceil_to_cache_line_size(0) == 0 );
+     * assert( ceil_to_cache_line_size(1) == cache_line_size );
+     * ```
+     */
+    constexpr auto ceil_to_cache_line_size [[gnu::const]] (
+        const std::size_t min_length
+    ) noexcept -> std::size_t {
+        return (min_length + cache_line_size - 1) / cache_line_size * cache_line_size;
+    }
+
+    /**
+     * @brief 分配器给出的内存块与缓存行的关系的统计.
+     * @see Monotonic_ShM_Buffer::cache_line_stats, ShM_Pool::cache_line_stats
+     */
+    struct Cache_Line_Stats {
+        std::size_t allocations;  ///< 被统计的 allocation 的数量.
+        std::size_t sharing;  ///< 其中, 首尾未与缓存行边界对齐 (因而可能与相邻内存块共享缓存行) 的数量.
+    };
+
+    /**
+     * @brief 跨进程的自旋锁, 可以直接放置在 shared memory 中.
+     * @details 只含一个 lock-free 的原子整数, 不依赖进程私有的地址或句柄.
+     *          竞争时先自旋若干次, 之后每次重试前 `yield`.  满足 *Lockable*,
+     *          可以搭配 `std::lock_guard` 等使用.
+     * @warning 持有锁的进程崩溃后, 锁不会被释放.
+     * @note example:
+     * ```
+     * auto lock = Spin_Lock{};
+     * {
+     *     const std::lock_guard _{lock};
+     *     assert( !lock.try_lock() );
+     * }
+     * assert( lock.try_lock() );
+     * lock.unlock();
+     * ```
+     */
+    class Spin_Lock {
+            std::atomic<std::uint32_t> locked{};
+            static_assert(decltype(locked)::is_always_lock_free);
+        public:
+            void lock() noexcept {
+                for (auto spins = 0u; this->locked.exchange(1, std::memory_order_acquire); )
+                    while (this->locked.load(std::memory_order_relaxed))
+                        if (++spins < 64)
+#ifdef __x86_64__
+                            _mm_pause();
+#else
+                            ;
+#endif
+                        else
+                            std::this_thread::yield();
+            }
+            bool try_lock() noexcept {
+                return !this->locked.load(std::memory_order_relaxed)
+                       && !this->locked.exchange(1, std::memory_order_acquire);
+            }
+            void unlock() noexcept {
+                this->locked.store(0, std::memory_order_release);
+            }
+    };
+
+    /**
+     * @brief 64 位 FNV-1a 哈希.
+     * @details 与 `std::hash` 不同, 其结果不依赖于标准库的实现, 因此可以存放在
+     *          shared memory 中, 供 (可能以不同工具链编译的) 其它进程使用.
+     */
+    constexpr auto stable_hash [[gnu::pure]] (const std::string_view bytes) noexcept {
+        auto hash = std::uint64_t{0xcbf2'9ce4'8422'2325};
+        for (const auto byte : bytes)
+            hash = (hash ^ (unsigned char)byte) * std::uint64_t{0x100'0000'01b3};
+        return hash;
+    }
+
+    /**
+     * @brief 跨进程的 futex 等待: 若 `word` 的值仍为 `expected`, 则睡眠, 直到被
+     *        `futex_wake` 唤醒或超时.
+     * @details 不带 `FUTEX_PRIVATE_FLAG`, 因此 `word` 可以位于 shared memory 中, 被
+     *          各进程映射在不同的地址.  可能虚假唤醒, 调用者应重新检查条件.  非 Linux
+     *          平台上退化为 `yield`.
+     * @return 超时时返回 `false`.
+     */
+    inline auto futex_wait(
+        const std::atomic<std::uint32_t>& word, const std::uint32_t expected,
+        const std::optional<std::chrono::nanoseconds> timeout = std::nullopt
+    ) noexcept -> bool {
+        static_assert(sizeof(word) == sizeof(std::uint32_t));
+#ifdef __linux__
+        ::timespec relative{};
+        if (timeout) {
+            const auto remaining = std::max(*timeout, std::chrono::nanoseconds{});
+            const auto seconds = std::chrono::floor<std::chrono::seconds>(remaining);
+            relative = {.tv_sec = seconds.count(), .tv_nsec = (remaining - seconds).count()};
+        }
+        return ::syscall(
+            SYS_futex, &word, FUTEX_WAIT, expected, timeout ? &relative : nullptr, nullptr, 0
+        ) == 0 || errno != ETIMEDOUT;
+#else
+        std::ignore = expected, std::ignore = timeout;
+        std::this_thread::yield();
+        return true;
+#endif
+    }
+    /**
+     * @brief 唤醒至多 `count` 个在 `word` 上 `futex_wait` 的线程 (可属于任何进程).
+     */
+    inline void futex_wake(std::atomic<std::uint32_t>& word, const int count = INT_MAX) noexcept {
+#ifdef __linux__
+        ::syscall(SYS_futex, &word, FUTEX_WAKE, count, nullptr, nullptr, 0);
+#else
+        std::ignore = word, std::ignore = count;
+#endif
+    }
 }
 
 
@@ -222,6 +406,10 @@ inline namespace utils {
  * @note 文档约定:
  *       称 `Shared_Memory` **[*creat*=true]**  实例为 creator,
  *          `Shared_Memory` **[*creat*=false]** 实例为 accessor.
+ * @note 除了 POSIX shared memory 的名字 (`/name`), 目标文件也可以是普通文件的绝对
+ *       路径 (例如 `/var/lib/app/arena`, 见 `POSIX::is_file_path`), 此时以 `MAP_SHARED`
+ *       映射该文件.  普通文件在重启后依然存在, 并通过 page cache 加载; 持久化的时机
+ *       由 `Shared_Memory::sync` 显式控制.
  * @tparam creat 是否新建文件以供映射.
  * @tparam writable 是否允许在映射的区域写数据.
  */
@@ -239,6 +427,13 @@ class Shared_Memory: public std::span<
             >
         >;
         std::string name;
+        [[no_unique_address]] std::conditional_t<creat, bool, std::monostate> persistent{};
+        [[no_unique_address]] std::conditional_t<creat, std::size_t, std::monostate> alignment{};
+        /* 被映射的对象的身份: 名字被 unlink 后重建, 得到的是另一个对象. */
+        using Identity = std::pair<::dev_t, ::ino_t>;
+        [[no_unique_address]] std::conditional_t<creat, std::monostate, Identity> identity{};
+        /* 映射是否带有 `PROT_EXEC` (只读映射才会尝试, 见 `map_shm`). */
+        [[no_unique_address]] std::conditional_t<creat, std::monostate, bool> executable{};
     public:
         /**
          * @brief 创建 shared memory 并映射, 可供其它进程打开以读写.
@@ -251,22 +446,31 @@ class Shared_Memory: public std::span<
          * @details 根据 `name` 创建一个临时文件, 并将其映射到进程自身的
          *          RAM 中.  临时文件的文件描述符在构造函数返回前就会被删除.
          * @warning `name` 不能和已有 POSIX shared memory 重复, 否则会崩溃.
+         * @param alignment 可选.  映射后的起始地址按此值 (须为 2 的幂) 对齐.  不超过📄页面
+         *                  大小时没有额外开销; 否则先预留一段更长的地址空间, 再将 shared
+         *                  memory 固定映射到其中对齐的位置, 并修剪掉首尾多余的部分.
          * @note example (该 constructor 会推导类的模板实参):
          * ```
          * Shared_Memory shm{"/ipcator.Shared_Memory-creator", 1234};
          * static_assert( std::is_same_v<decltype(shm), Shared_Memory<true, true>> );
          * ```
+         * @note example (按 2 MiB 对齐):
+         * ```
+         * Shared_Memory shm{"/ipcator.Shared_Memory-aligned", 5000, 2uz << 20};
+         * assert( std::uintptr_t(std::data(shm)) % (2uz << 20) == 0 );
+         * assert( shm.get_alignment() == 2uz << 20 );
+         * ```
          */
         Shared_Memory(
             const std::string
 #ifdef IPCATOR_OFAST
                              &
 #endif
-                               name, const std::size_t size
+                               name, const std::size_t size, const std::size_t alignment = 0
         ) requires(creat): span{
-            Shared_Memory::map_shm(name, size),
+            Shared_Memory::map_shm(name, size, alignment),
             size,
-        }, name{name} {
+        }, name{name}, alignment{alignment} {
 #ifdef IPCATOR_LOG
                 std::clog << std::format("创建了 Shared_Memory: \033[32m{}\033[0m", *this) + '\n';
 #endif
@@ -295,14 +499,43 @@ class Shared_Memory: public std::span<
 #endif
                                name
         ) noexcept(noexcept(Shared_Memory::map_shm(""s))) requires(!creat)
+        : Shared_Memory{std::in_place, Shared_Memory::map_shm(name), name} {
+#ifdef IPCATOR_LOG
+                std::clog << std::format("创建了 Shared_Memory: \033[32m{}\033[0m\n", *this) + '\n';
+#endif
+        }
+        /**
+         * @brief 接管一个已存在的 POSIX shared memory (通常是此前被 `Shared_Memory::persist`
+         *        过的), 成为它的 creator.  之后的行为和新建的 creator 一致.
+         * @param alignment 同 `Shared_Memory::Shared_Memory(std::string, std::size_t, std::size_t)`.
+         * @note 若目标文件不存在, 其行为同 accessor 的构造函数.
+         * @note example:
+         * ```
+         * auto old = Shared_Memory{"/ipcator.adopt", 100};
+         * old[7] = 7;
+         * old.persist();
+         * old = {"/ipcator.adopt-other", 1};  // 析构, 但不 unlink.
+         * auto adopted = Shared_Memory{std::adopt_lock, "/ipcator.adopt"};
+         * static_assert( std::is_same_v<decltype(adopted), Shared_Memory<true, true>> );
+         * assert( adopted[7] == 7 && std::size(adopted) == 100 );
+         * ```
+         */
+        Shared_Memory(
+            std::adopt_lock_t,
+            const std::string
+#ifdef IPCATOR_OFAST
+                             &
+#endif
+                               name, const std::size_t alignment = 0
+        ) requires(creat)
         : span{
             [&]() -> span {
-                const auto [addr, length] = Shared_Memory::map_shm(name);
-                return {addr, length};
+                const auto area = Shared_Memory<false, true>::map_shm(name, alignment);
+                return {area.addr, area.length};
             }()
-        }, name{name} {
+        }, name{name}, alignment{alignment} {
 #ifdef IPCATOR_LOG
-                std::clog << std::format("创建了 Shared_Memory: \033[32m{}\033[0m\n", *this) + '\n';
+                std::clog << std::format("接管了 Shared_Memory: \033[32m{}\033[0m", *this) + '\n';
 #endif
         }
         /**
@@ -320,13 +553,18 @@ class Shared_Memory: public std::span<
             // Self 的 destructor 靠 `span` 是否为空来
             // 判断是否持有所有权, 所以此处需要强制置空.
             std::exchange<span>(other, {})
-        }, name{std::move(other.name)} {}
+        }, name{std::move(other.name)}, persistent{other.persistent},
+          alignment{other.alignment}, identity{other.identity}, executable{other.executable} {}
         /**
          * @brief 实现交换语义.
          */
         friend void swap(Shared_Memory& a, decltype(a) b) noexcept {
             std::swap<span>(a, b);
             std::swap(a.name, b.name);
+            std::swap(a.persistent, b.persistent);
+            std::swap(a.alignment, b.alignment);
+            std::swap(a.identity, b.identity);
+            std::swap(a.executable, b.executable);
         }
         /**
          * @brief 实现赋值语义.
@@ -367,7 +605,8 @@ class Shared_Memory: public std::span<
 
             // 🚫 Writer 将要拒绝任何新的连接请求:
             if constexpr (creat)
-                ::shm_unlink(this->name.c_str());
+                if (!this->persistent)
+                    POSIX::shm_unlink(this->name);
                 // 此后的 ‘shm_open’ 调用都将失败.
                 // 当所有 shm 都被 ‘munmap’ed 后, 共享内存将被 deallocate.
 
@@ -391,15 +630,124 @@ class Shared_Memory: public std::span<
          */
         auto& get_name() const { return this->name; }
 
+        /**
+         * @brief 构造时要求的对齐 (0 表示无要求).
+         */
+        auto get_alignment() const noexcept requires(creat) { return this->alignment; }
+
+        /**
+         * @brief 令 creator 在析构时不再 unlink 目标文件, 使 POSIX shared memory 在
+         *        所有映射都解除之后仍然存在, 可被之后的进程重新打开或接管.
+         * @param on 设为 false 以恢复默认行为.
+         * @see Shared_Memory::Shared_Memory(std::adopt_lock_t, std::string, std::size_t)
+         */
+        void persist(const bool on = true) noexcept requires(creat) {
+            this->persistent = on;
+        }
+
+        /**
+         * @brief 判断名字是否已指向另一个对象, 即原对象被 unlink 之后, 又有同名的对象被创建.
+         * @details 比较映射时记下的 (设备号, inode) 和名字当前对应的对象的.  此时本映射仍然
+         *          可访问, 但读到的是已成为孤儿的旧对象, 看不到新对象上的写入.
+         * @return 名字当前不存在时返回 false: 旧对象是唯一可读的版本.
+         * @note 代价是一次 `shm_open` + `fstat` + `close`.
+         * @note example:
+         * ```
+         * auto creator = std::optional<Shared_Memory<true>>{{"/ipcator.stale", 1}};
+         * auto accessor = Shared_Memory{"/ipcator.stale"};
+         * assert( !accessor.is_stale() );
+         * creator.reset();
+         * assert( !accessor.is_stale() );
+         * creator.emplace("/ipcator.stale", 1);
+         * assert( accessor.is_stale() );
+         * ```
+         */
+        auto is_stale [[gnu::cold]] () const noexcept -> bool requires(!creat) {
+            const auto fd = POSIX::shm_open(this->name, O_RDONLY, 0);
+            if (fd == -1)
+                return false;
+            struct ::stat current;
+            const auto result = ::fstat(fd, &current);
+            ::close(fd);
+            return result != -1
+                   && Identity{current.st_dev, current.st_ino} != this->identity;
+        }
+
+        /**
+         * @brief 判断映射是否带有 `PROT_EXEC`.
+         * @details 只读的映射会尝试 `PROT_EXEC`; 失败时 (例如 `/dev/shm` 以 `noexec` 挂载)
+         *          退回到不可执行的映射.  可写的映射从不可执行 (W^X).
+         * @note example:
+         * ```
+         * auto creator = Shared_Memory{"/ipcator.exec", 1};
+         * assert( !(Shared_Memory<false, true>{"/ipcator.exec"}.is_executable()) );  // W^X.
+         * ```
+         */
+        auto is_executable() const noexcept -> bool requires(!creat) {
+            return this->executable;
+        }
+
+        /**
+         * @brief 将 [`offset`, `offset`+`length`) 范围内被修改过的📄页面写回目标文件.
+         * @param wait 为 true 时 (`msync(MS_SYNC)`), 等到数据落盘才返回; 否则只是发起
+         *             写回 (Linux 上用 `sync_file_range`), 并不等待.
+         * @details 仅对普通文件有意义; 对 POSIX shared memory 而言, 它位于 tmpfs 上,
+         *          没有可写回的存储.
+         * @exception 写回失败时抛出 `std::system_error`.
+         * @note example:
+         * ```
+         * const auto path = std::filesystem::temp_directory_path() / "ipcator.sync";
+         * auto file = Shared_Memory{path.native(), 8192};
+         * file[4096] = 'S';
+         * file.sync(4096, 1);
+         * file.sync(0, std::size(file), false);
+         * ```
+         */
+        void sync [[gnu::cold]] (
+            const std::size_t offset = 0, const std::size_t length = -1, const bool wait = true
+        ) const requires(writable) {
+            assert(offset <= std::size(*this));
+            const auto begin = offset / ::getpagesize() * ::getpagesize(),
+                       end = ceil_to_page_size(offset + std::min(length, std::size(*this) - offset));
+            if (begin == end)
+                return;
+
+            const auto result = [&] {
+#ifdef __linux__
+                if (!wait) {
+                    if (!POSIX::is_file_path(this->name))
+                        return 0;
+                    const auto fd = ::open(this->name.c_str(), O_RDONLY);
+                    if (fd == -1)
+                        return -1;
+                    const auto result = ::sync_file_range(fd, begin, end - begin, SYNC_FILE_RANGE_WRITE);
+                    ::close(fd);
+                    return result;
+                }
+#endif
+                return ::msync(
+                    const_cast<char *>(std::data(*this)) + begin, end - begin,
+                    wait ? MS_SYNC : MS_ASYNC
+                );
+            }();
+            if (result == -1) [[unlikely]]
+                throw std::system_error{errno, std::system_category(), "写回 ‘" + this->name + "’ 失败"};
+        }
+
+        /**
+         * @param size_alignment 对于 creator, 依次是 shared memory 的大小和映射的对齐要求
+         *                       (不超过📄页面大小时, 视作无要求); 对于 accessor, 为空
+         *                       或仅有对齐要求.
+         */
 #if __has_cpp_attribute(nodiscard)
         [[nodiscard]]
 #endif
-        static auto map_shm(const std::string& name, const std::unsigned_integral auto... size)
+        static auto map_shm(const std::string& name, const std::unsigned_integral auto... size_alignment)
             noexcept(false)  // 创建时可能文件已存在; 打开时可能报 “no such file” 错误.
-            requires(sizeof...(size) == creat)
+            requires(creat ? sizeof...(size_alignment) == 2 : sizeof...(size_alignment) <= 1)
         {
             assert(
-                name.length() <= NAME_MAX
+                name.length() <= (POSIX::is_file_path(name) ? PATH_MAX : NAME_MAX)
                 // 实际上 POSIX 没有规定 name 的长度上限, 但我认为需要一个保守值.
             );
 
@@ -425,7 +773,7 @@ class Shared_Memory: public std::span<
                         // 不要加句号:
                         creat ? "重名的 共享内存对象 已存在, 等待它被删除... creator 等待超时"
                               : "共享内存对象 仍未被创建, 导致 accessor 等待超时",
-                        std::format(
+                        POSIX::is_file_path(name) ? name : std::format(
 #ifdef __linux__
                             "/dev/shm/"
 #elif defined __FreeBSD__ || defined __APPLE__
@@ -441,8 +789,8 @@ class Shared_Memory: public std::span<
                         )
                     };
             }(std::bind(
-                ::shm_open,
-                name.c_str(),
+                POSIX::shm_open,
+                std::cref(name),
                 (creat ? O_CREAT|O_EXCL : 0) | (writable ? O_RDWR : O_RDONLY),
                 0777
             ));
@@ -457,9 +805,10 @@ class Shared_Memory: public std::span<
                 // 设置 shm obj 的大小:
                 const auto result_resize [[maybe_unused]] = ::ftruncate(
                     fd,
-                    size...
 #ifdef __cpp_pack_indexing
-                           [0]
+                    size_alignment...[0]
+#else
+                    [](auto size, ...) { return size; }(size_alignment...)
 #endif
                 );
                 assert(result_resize != -1);
@@ -470,9 +819,9 @@ class Shared_Memory: public std::span<
                     if constexpr (creat)
                         return
 #ifdef __cpp_pack_indexing
-                            size...[0]
+                            size_alignment...[0]
 #else
-                            [](auto size, ...) { return size; }(size...)
+                            [](auto size, ...) { return size; }(size_alignment...)
 #endif
                         ;
                     else
@@ -480,36 +829,68 @@ class Shared_Memory: public std::span<
                         for (struct ::stat shm; true; std::this_thread::yield())
                             if (::fstat(fd, &shm); shm.st_size)
                                 [[likely]] return shm.st_size + 0uz;
+                }(),
+                identity=[&] {
+                    if constexpr (creat)
+                        return std::monostate{};
+                    else {
+                        struct ::stat shm;
+                        ::fstat(fd, &shm);
+                        return Identity{shm.st_dev, shm.st_ino};
+                    }
+                }(),
+                alignment=[&]() -> std::size_t {
+                    if constexpr (creat)
+                        return
+#ifdef __cpp_pack_indexing
+                            size_alignment...[1]
+#else
+                            [](auto, auto alignment) { return alignment; }(size_alignment...)
+#endif
+                        ;
+                    else
+                        return (0uz + ... + size_alignment);
                 }()
+#ifdef IPCATOR_OFAST
+                , file_backed=POSIX::is_file_path(name)
+#endif
             ] {
                 assert(size);
 #if __has_cpp_attribute(assume)
                 [[assume(size)]];  // POSIX mmap 要求.
 #endif
+                // 对齐要求超出📄页面大小时, 需要自己挑选映射的位置:
+                const auto placement = alignment > ::getpagesize() + 0u
+                                       ? Shared_Memory::reserve_aligned_area(size, alignment)
+                                       : nullptr;
+                auto executable = false;
                 const auto area_addr = [&] {
 #ifdef IPCATOR_OFAST
+                    // 只对 `/dev/shm` 记忆失败; 普通文件可能位于不同的文件系统, 须逐个尝试:
                     static constinit auto failed_because_of_exec = false;
 #endif
                     const auto mmap_executable = [&](bool use_prot_exec) {
                         return ::mmap(
-                            nullptr, size,
+                            placement, size,
                             PROT_READ | (writable ? PROT_WRITE : 0) | (use_prot_exec ? PROT_EXEC : 0),
-                            MAP_SHARED | (!writable ? MAP_NORESERVE : 0),
+                            MAP_SHARED | (!writable ? MAP_NORESERVE : 0) | (placement ? MAP_FIXED : 0),
                             fd, 0
                         );
                     };
 
-                    auto addr = mmap_executable(
-#ifndef IPCATOR_OFAST
-                        true
-#else
-                        failed_because_of_exec ? false : true
+                    // W^X: 可写的映射从不可执行; 只读的映射才尝试 `PROT_EXEC`, 以便执行其它
+                    // 进程写入的机器码 (见 `ShM_Code_Cache`):
+                    const auto try_exec = !writable
+#ifdef IPCATOR_OFAST
+                                          && (file_backed || !failed_because_of_exec)
 #endif
-                    );
-                    if (addr == MAP_FAILED && errno == EPERM)
+                    ;
+                    auto addr = mmap_executable(try_exec);
+                    executable = try_exec && addr != MAP_FAILED;
+                    if (try_exec && addr == MAP_FAILED && errno == EPERM)
 #ifdef IPCATOR_OFAST
                         [[unlikely]]  // 因为只会设置这么一次:
-                        failed_because_of_exec = true,
+                        failed_because_of_exec = failed_because_of_exec || !file_backed,
 #endif
 #ifdef IPCATOR_LOG
                         std::clog << "Failed to map shm as PROT_EXEC.\n",
@@ -517,6 +898,7 @@ class Shared_Memory: public std::span<
                         addr = mmap_executable(false);
 
                     assert(addr != MAP_FAILED);
+                    assert(!placement || addr == placement);
                     return (char *)addr;
                 }();
 #if !__has_cpp_attribute(gnu::cleanup)
@@ -535,11 +917,46 @@ class Shared_Memory: public std::span<
                             char, const char
                         > *const addr;
                         const std::size_t length;
-                    } area{area_addr, size};
+                        const Identity identity;
+                        const bool executable;
+                    } area{area_addr, size, identity, executable};
                     return area;
                 }
             }();
         }
+    private:
+        /* accessor 的构造函数的实现, 顺带记下被映射的对象的身份. */
+        Shared_Memory(std::in_place_t, const auto& area, const std::string& name) noexcept requires(!creat)
+        : span{area.addr, area.length}, name{name}, identity{area.identity},
+          executable{area.executable} {}
+        /**
+         * @brief 预留一段起始地址按 `alignment` 对齐、长度为 `size` 的地址空间
+         *        (`PROT_NONE`), 供之后以 `MAP_FIXED` 覆盖映射.
+         * @details 多预留 `alignment` 字节, 然后把首尾不需要的部分 unmap 掉.
+         */
+        static auto reserve_aligned_area [[gnu::cold]] (
+            const std::size_t size, const std::size_t alignment
+        ) noexcept -> void * {
+            assert((alignment & (alignment - 1)) == 0);  // 2 的幂.
+
+            const auto length = ceil_to_page_size(size);
+            const auto reserved = (char *)::mmap(
+                nullptr, length + alignment,
+                PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                -1, 0
+            );
+            assert(reserved != MAP_FAILED);
+
+            const auto aligned = (char *)(
+                (std::uintptr_t(reserved) + alignment - 1) & ~(alignment - 1)
+            );
+            if (const auto head = aligned - reserved)
+                ::munmap(reserved, head);
+            if (const auto tail = reserved + length + alignment - (aligned + length))
+                ::munmap(aligned + length, tail);
+            return aligned;
+        }
+    public:
 
         /**
          * @brief 🖨️打印内存布局到一个字符串.  调试用.
@@ -608,9 +1025,15 @@ class Shared_Memory: public std::span<
 Shared_Memory(
     std::convertible_to<std::string> auto, std::integral auto
 ) -> Shared_Memory<true>;
+Shared_Memory(
+    std::convertible_to<std::string> auto, std::integral auto, std::integral auto
+) -> Shared_Memory<true>;
 Shared_Memory(
     std::convertible_to<std::string> auto
 ) -> Shared_Memory<false>;
+Shared_Memory(
+    std::adopt_lock_t, std::convertible_to<std::string> auto, std::integral auto...
+) -> Shared_Memory<true>;
 
 static_assert(
     !std::copy_constructible<Shared_Memory<true>>
@@ -757,8 +1180,361 @@ inline namespace utils {
         assert(full_name.length() == len_name);
         return full_name;
     }
+
+    /**
+     * @brief 将一大块数据拷贝到 (通常是刚分配的) 共享内存块中, 供其它进程读取.
+     * @details 与 `std::memcpy` 不同, 对于较大的 `n`, 使用 non-temporal (streaming)
+     *          存储指令绕过缓存直接写入内存, 以免写者用自己不会再读的数据把缓存
+     *          冲刷掉.  根据 CPU 在运行时支持的指令集, 依次选用 AVX-512, AVX2, SSE2;
+     *          都不支持 (或并非 x86-64) 时退化为 `std::memcpy`.  拷贝结束前执行 store
+     *          fence, 因此随后以 release 语义发布该内存块的位置即可.
+     * @return `dst_block`.
+     * @note example:
+     * ```
+     * auto buffer = Monotonic_ShM_Buffer{};
+     * std::vector<char> payload(1 << 20, 'x');
+     * auto block = (char *)buffer.allocate(std::size(payload));
+     * publish_copy(block, std::data(payload), std::size(payload));
+     * assert( std::equal(block, block + std::size(payload), std::cbegin(payload)) );
+     * ```
+     */
+    inline auto publish_copy [[gnu::hot, gnu::nonnull]] (
+        void *const dst_block, const void *const src, const std::size_t n
+    ) noexcept -> void * {
+        // 数据量太小的时候, 绕过缓存反而得不偿失:
+        if (n < 4uz * 4096)
+            return std::memcpy(dst_block, src, n);
+
+#ifdef __x86_64__
+        struct Stream {
+            /* 用 memcpy 将 dst 对齐到向量宽度; 中间部分逐个向量地 stream; 最后用 memcpy 收尾. */
+            static void head(char *&dst, const char *&src, std::size_t& n, const std::size_t width) noexcept {
+                const auto head = std::min(n, -std::uintptr_t(dst) & (width - 1));
+                std::memcpy(dst, src, head);
+                dst += head, src += head, n -= head;
+            }
+            static void tail(char *const dst, const char *const src, const std::size_t n) noexcept {
+                std::memcpy(dst, src, n);
+                _mm_sfence();  // Non-temporal 存储是弱序的.
+            }
+            [[gnu::target("sse2")]]
+            static void sse2(char *dst, const char *src, std::size_t n) noexcept {
+                head(dst, src, n, 16);
+                for (; n >= 16; dst += 16, src += 16, n -= 16)
+                    _mm_stream_si128((__m128i *)dst, _mm_loadu_si128((const __m128i *)src));
+                tail(dst, src, n);
+            }
+            [[gnu::target("avx2")]]
+            static void avx2(char *dst, const char *src, std::size_t n) noexcept {
+                head(dst, src, n, 32);
+                for (; n >= 32; dst += 32, src += 32, n -= 32)
+                    _mm256_stream_si256((__m256i *)dst, _mm256_loadu_si256((const __m256i *)src));
+                tail(dst, src, n);
+            }
+            [[gnu::target("avx512f")]]
+            static void avx512(char *dst, const char *src, std::size_t n) noexcept {
+                head(dst, src, n, 64);
+                for (; n >= 64; dst += 64, src += 64, n -= 64)
+                    _mm512_stream_si512((__m512i *)dst, _mm512_loadu_si512((const __m512i *)src));
+                tail(dst, src, n);
+            }
+        };
+        static const auto stream = []() noexcept -> void (*)(char *, const char *, std::size_t) {
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f"))
+                return Stream::avx512;
+            else if (__builtin_cpu_supports("avx2"))
+                return Stream::avx2;
+            else if (__builtin_cpu_supports("sse2"))
+                return Stream::sse2;
+            else
+                return nullptr;
+        }();
+        if (stream) [[likely]] {
+            stream((char *)dst_block, (const char *)src, n);
+            return dst_block;
+        }
+#endif
+        return std::memcpy(dst_block, src, n);
+    }
+
+    /**
+     * @brief 将 (只读的) 数据文件整个加载到一块新建的 shared memory 中, 供多个进程共享.
+     * @details 各进程各自把同一份 (可能数 GiB 的) 查找表读进私有内存, 既浪费 RSS 又
+     *          拖慢启动.  改为由一个进程调用本函数加载一次, 其余进程以 `ShM_Reader`
+     *          按名字 attach, 只需映射而无需拷贝.  文件被切分成按📄页面对齐的若干段,
+     *          由 `threads` 个线程并行 `pread`; 读之前通过 `posix_fadvise` (Linux 上
+     *          还有 `readahead`) 让内核提前预读.
+     * @param shm_name 目标 shared memory 的名字, 不能与已有的重复.
+     * @param threads 并行读取的线程数.  为 0 时视作 1.
+     * @return 持有所有权的 creator; 它析构后其它进程就无法再 attach.  若要脱离加载者
+     *         的生命周期, 调用 `Shared_Memory::persist`.
+     * @exception 文件无法打开时抛出 `std::filesystem::filesystem_error`; 读取失败时
+     *            抛出 `std::system_error`.
+     * @note 空文件会得到长度为 1 的 shared memory (POSIX 不允许长度为 0).
+     * @note 如果文件本身就位于 tmpfs (或者不在乎首次访问时的缺页), 无需加载: 以文件的
+     *       绝对路径作为名字, 直接用 `ShM_Reader` 映射即可, 见 `POSIX::is_file_path`.
+     * @note example:
+     * ```
+     * const auto path = std::filesystem::temp_directory_path() / "ipcator.table";
+     * {
+     *     auto file = Shared_Memory{path.native(), 100'000};
+     *     std::ranges::fill(file, 'T');
+     *     file.persist();
+     * }
+     * {
+     *     const auto shm = load_file(path, "/ipcator.table", 4);
+     *     assert( std::size(shm) == 100'000 );
+     *     auto rd = ShM_Reader{};  // 其它进程:
+     *     assert( *rd.template read<char>("/ipcator.table", 99'999) == 'T' );
+     * }
+     * std::filesystem::remove(path);
+     * ```
+     */
+    inline auto load_file(
+        const std::filesystem::path& path, std::string shm_name,
+        unsigned threads = std::thread::hardware_concurrency()
+    ) -> Shared_Memory<true> {
+        using POSIX::close;
+        const auto fd [[gnu::cleanup(close)]] = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1)
+            throw std::filesystem::filesystem_error{
+                "无法打开待加载的文件", path,
+                std::error_code{errno, std::system_category()}
+            };
+        struct ::stat file;
+        ::fstat(fd, &file);
+        const auto size = file.st_size + 0uz;
+
+        // 让内核尽早开始预读, 与下面的 `pread` 重叠:
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+#ifdef __linux__
+        ::readahead(fd, 0, size);
+#endif
+
+        auto shm = Shared_Memory{std::move(shm_name), std::max(size, 1uz)};
+
+        const auto chunk = ceil_to_page_size(size / std::max(threads, 1u) + 1);
+        std::vector<std::future<void>> readers;
+        for (auto offset = 0uz; offset < size; offset += chunk)
+            readers.push_back(std::async(std::launch::async, [&, offset] {
+                for (auto done = offset, end = std::min(offset + chunk, size); done < end; )
+                    if (const auto n = ::pread(fd, std::data(shm) + done, end - done, done); n > 0)
+                        done += n;
+                    else if (n == 0)
+                        throw std::system_error{
+                            std::make_error_code(std::errc::io_error),
+                            "加载 ‘" + path.native() + "’ 时文件被截短"
+                        };
+                    else if (errno != EINTR)
+                        throw std::system_error{errno, std::system_category(), "加载 ‘" + path.native() + "’ 失败"};
+            }));
+        // 等所有线程结束 (即使有失败的) 再抛出异常, 以免它们访问已析构的 `shm`:
+        for (auto& reader : readers)
+            reader.wait();
+        for (auto& reader : readers)
+            reader.get();
+
+        return shm;
+    }
 }
 
+
+/**
+ * @brief 找出 shared memory 中自上次快照以来被修改过的📄页面, 从而增量地做快照.
+ * @details 定期 checkpoint 大块的共享数据时, 只需拷贝变化了的页面, 代价与修改的
+ *          速率成正比, 而非与 shared memory 的大小成正比.  有两种方式找出脏页:
+ *          - 逐页哈希 (默认): 快照时记下每个页面的哈希值, 之后比较.  需要读一遍整个
+ *            区域, 但能发现任何进程的写入, 且写入方无需暂停.
+ *          - Soft-dirty (Linux, 须显式开启): 快照后向 `/proc/self/clear_refs` 写入
+ *            "4", 之后从 `/proc/self/pagemap` 读出每个页面的 soft-dirty 位.  几乎没有
+ *            开销, 但只能看到本进程 (通过本进程的映射) 的写入, 且有下述限制.  内核不
+ *            支持 soft-dirty 时退化为逐页哈希.
+ * @note 在第一次快照之前, 所有页面都被视为脏页.
+ * @warning 不得比被追踪的 `Shared_Memory` 活得更久.
+ * @warning `/proc/self/clear_refs` 会清除整个进程的 soft-dirty 位, 因此同一进程中
+ *          同时只应有一个使用 soft-dirty 的 tracker.
+ * @warning 使用 soft-dirty 时, 以当前状态为基准 (`reset`, `snapshot`, `dirty_pages(true)`)
+ *          需要先读出脏页再清除 soft-dirty 位, 内核不提供原子的 “读并清除”.  在这两步之间
+ *          写入的页面会被永久漏掉 (而不只是在快照中新旧混杂), 因此写入方必须在此期间暂停.
+ *          逐页哈希的方式没有该限制.
+ */
+class Dirty_Page_Tracker {
+        std::span<const char> region;
+        bool soft_dirty;
+        bool has_baseline = false;
+        std::vector<std::size_t> page_hashes;  // 仅用于逐页哈希的方式.
+    public:
+        /**
+         * @param use_soft_dirty 是否 (在内核支持时) 使用 soft-dirty, 否则逐页哈希.  仅当
+         *                       只有本进程会写 `shm`, 且写入方在以当前状态为基准时会
+         *                       暂停, 才可开启; 否则会漏掉脏页, 见类的说明.
+         */
+        template <bool creat, auto writable>
+        explicit Dirty_Page_Tracker(
+            const Shared_Memory<creat, writable>& shm, const bool use_soft_dirty = false
+        ) : region{shm}, soft_dirty{use_soft_dirty && soft_dirty_available()} {
+            assert(std::uintptr_t(std::data(this->region)) % ::getpagesize() == 0);
+        }
+
+        auto num_pages() const noexcept {
+            return ceil_to_page_size(std::size(this->region)) / ::getpagesize();
+        }
+
+        /**
+         * @brief 被追踪的区域.  页面的序号都相对于它的起始地址.
+         */
+        auto tracked_region() const noexcept { return this->region; }
+
+        /**
+         * @brief 自上次快照 (或 `reset`) 以来被修改过的页面的序号, 升序.
+         * @param rebase 是否同时以当前状态作为基准.  与之后再调用 `reset` 相比,
+         *               不会漏掉两次调用之间的写入.
+         * @warning 使用 soft-dirty 且 `rebase` 时, 写入方必须暂停, 见类的说明.
+         */
+        auto dirty_pages(const bool rebase = false) -> std::vector<std::size_t> {
+            return this->collect(rebase);
+        }
+
+        /**
+         * @brief 将当前状态作为基准, 之后的修改才算脏页.
+         */
+        void reset() {
+            this->collect(true);
+        }
+
+        /**
+         * @brief 将脏页拷贝到 `dst` 中相同的偏移量处, 然后以当前状态为基准.
+         * @param dst 通常是另一块 `Shared_Memory`, 比如以普通文件为目标的 (见
+         *            `POSIX::is_file_path`).  长度不小于被追踪的区域.
+         * @return 拷贝的页面数.
+         * @note 在快照期间写入的页面, 其快照的内容可能是新旧混杂的; 需要一致的
+         *       快照时, 应在写入方暂停期间调用.
+         * @note example:
+         * ```
+         * const auto page = ::getpagesize() + 0uz;
+         * auto shm = Shared_Memory{"/ipcator.tracked", 16 * page};
+         * auto backup = Shared_Memory{"/ipcator.backup", std::size(shm)};
+         * auto tracker = Dirty_Page_Tracker{shm};
+         * assert( tracker.snapshot(backup) == 16 );  // 第一次: 全部拷贝.
+         * shm[3 * page] = 'a';
+         * shm[9 * page + 5] = 'b';
+         * assert( tracker.dirty_pages() == (std::vector{3uz, 9uz}) );
+         * assert( tracker.snapshot(backup) == 2 );
+         * assert( backup[9 * page + 5] == 'b' );
+         * assert( tracker.dirty_pages().empty() );
+         * auto local = Dirty_Page_Tracker{shm, true};  // 只有本进程写入, 可用 soft-dirty.
+         * local.reset();
+         * shm[5 * page] = 'c';
+         * assert( local.dirty_pages() == (std::vector{5uz}) );
+         * ```
+         */
+        auto snapshot(const std::span<char> dst) -> std::size_t {
+            assert(std::size(dst) >= std::size(this->region));
+            const auto pages = this->collect(true);
+
+            // 将相邻的脏页合并成一次拷贝:
+            const auto page_size = ::getpagesize() + 0uz;
+            for (auto run = std::cbegin(pages); run != std::cend(pages); ) {
+                auto run_end = std::next(run);
+                while (run_end != std::cend(pages) && *run_end == *std::prev(run_end) + 1)
+                    ++run_end;
+                const auto offset = *run * page_size;
+                const auto length = std::min(
+                    (*std::prev(run_end) + 1) * page_size, std::size(this->region)
+                ) - offset;
+                publish_copy(std::data(dst) + offset, std::data(this->region) + offset, length);
+                run = run_end;
+            }
+            return std::size(pages);
+        }
+    private:
+        /* 找出脏页; `rebase` 时以当前状态作为新的基准. */
+        auto collect(const bool rebase) -> std::vector<std::size_t> {
+            std::vector<std::size_t> dirty;
+            const auto num_pages = this->num_pages();
+            const auto page_size = ::getpagesize() + 0uz;
+
+            if (!this->has_baseline) {
+                dirty.resize(num_pages);
+                std::iota(std::begin(dirty), std::end(dirty), 0uz);
+            } else if (this->soft_dirty) {
+                std::vector<std::uint64_t> entries(num_pages);
+                using POSIX::close;
+                const auto pagemap [[gnu::cleanup(close)]] = ::open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC);
+                // 事先打开, 使读出与清除紧挨着, 尽量缩小会漏掉写入的窗口 (见类的说明):
+                const auto clear_refs [[gnu::cleanup(close)]] = rebase
+                    ? ::open("/proc/self/clear_refs", O_WRONLY | O_CLOEXEC) : -1;
+                const auto nbytes [[maybe_unused]] = ::pread(
+                    pagemap, std::data(entries), num_pages * sizeof(std::uint64_t),
+                    std::uintptr_t(std::data(this->region)) / page_size * sizeof(std::uint64_t)
+                );
+                if (rebase) {
+                    const auto result [[maybe_unused]] = ::write(clear_refs, "4", 1);
+                    assert(result == 1);
+                }
+                assert(nbytes == ::ssize_t(num_pages * sizeof(std::uint64_t)));
+                for (auto i = 0uz; i < num_pages; ++i)
+                    if (entries[i] >> 55 & 1)  // Soft-dirty 位.
+                        dirty.push_back(i);
+            }
+
+            if (!this->soft_dirty) {
+                if (rebase)
+                    this->page_hashes.resize(num_pages);
+                for (auto i = 0uz; i < num_pages; ++i) {
+                    const auto hash = std::hash<std::string_view>{}({
+                        std::data(this->region) + i * page_size,
+                        std::min(page_size, std::size(this->region) - i * page_size)
+                    });
+                    if (this->has_baseline && hash != this->page_hashes[i])
+                        dirty.push_back(i);
+                    if (rebase)
+                        this->page_hashes[i] = hash;
+                }
+            } else if (rebase && !this->has_baseline) {  // 否则已在读出脏页之后立即清除了.
+                using POSIX::close;
+                const auto clear_refs [[gnu::cleanup(close)]] = ::open("/proc/self/clear_refs", O_WRONLY | O_CLOEXEC);
+                const auto result [[maybe_unused]] = ::write(clear_refs, "4", 1);
+                assert(result == 1);
+            }
+
+            if (rebase)
+                this->has_baseline = true;
+            return dirty;
+        }
+
+        /* 内核是否支持 soft-dirty (`CONFIG_MEM_SOFT_DIRTY`), 且本进程有权使用. */
+        static auto soft_dirty_available() noexcept -> bool {
+            static const auto available = [] {
+#ifdef __linux__
+                if (::access("/proc/self/clear_refs", W_OK) != 0)
+                    return false;
+                // 新建的映射一定是 soft-dirty 的:
+                const auto page = (volatile char *)::mmap(
+                    nullptr, ::getpagesize(), PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
+                );
+                if (page == MAP_FAILED)
+                    return false;
+                *page = 1;
+                std::uint64_t entry = 0;
+                {
+                    using POSIX::close;
+                    const auto pagemap [[gnu::cleanup(close)]] = ::open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC);
+                    ::pread(pagemap, &entry, sizeof entry, std::uintptr_t(page) / ::getpagesize() * sizeof entry);
+                }
+                ::munmap((void *)page, ::getpagesize());
+                return bool(entry >> 55 & 1);
+#else
+                return false;
+#endif
+            }();
+            return available;
+        }
+};
+
 
 #ifndef IPCATOR_LOG
 # define IPCATOR_LOG_ALLO_OR_DEALLOC(color)  (void())
@@ -774,6 +1550,48 @@ inline namespace utils {
 )
 #endif
 
+
+/**
+ * @brief `ShM_Resource` 的配置选项.
+ */
+struct ShM_Resource_Options {
+    /**
+     * @brief 非空时开启持久化: 它是一个 POSIX shared memory (即 manifest) 的名字.
+     * @details 有序退出 (即 `ShM_Resource` 析构) 时, 将所有 `Shared_Memory<true>` 的
+     *          名字和对齐要求记入 manifest, 并且不 unlink 它们.  之后以相同的 manifest
+     *          构造的 `ShM_Resource` (通常位于重启后的进程中) 会接管这些 POSIX shared
+     *          memory, 其中的数据, 以及 (名字, 偏移量) 形式的消息位置都保持不变.
+     * @warning 仅 `ShM_Resource` 支持.  `Monotonic_ShM_Buffer` 和 `ShM_Pool` 的簿记信息
+     *          位于私有内存, 重启后无法恢复, 因此忽略该选项.
+     * @see ShM_Resource::commit_manifest, ShM_Resource::discard_manifest
+     */
+    std::string manifest = {};
+    /**
+     * @brief 非空时, 新分配的内存都位于该目录下的普通文件中 (而非 `/dev/shm`), 例如
+     *        tmpfs, ext4, xfs 上的目录.  必须是绝对路径.
+     * @details 与 `manifest` (也应是该目录下的路径) 一起使用, 则构建的数据在重启
+     *          (包括操作系统重启) 之后依然存在, 启动时只需经由 page cache 加载.
+     * @see Shared_Memory::sync
+     * @note example:
+     * ```
+     * const auto dir = std::filesystem::temp_directory_path() / "ipcator.arena";
+     * std::filesystem::create_directories(dir);
+     * {
+     *     auto allocator = ShM_Resource<std::set>{{.directory = dir}};
+     *     auto area = (char *)allocator.allocate(100);
+     *     auto& file = allocator.find_arena(area);
+     *     assert( file.get_name().starts_with(dir.native() + '/') );
+     *     area[0] = 'F';
+     *     file.sync();
+     *     auto rd = ShM_Reader{};  // 读取方式不变.
+     *     assert( *rd.template read<char>(file.get_name(), 0) == 'F' );
+     * }
+     * std::filesystem::remove_all(dir);
+     * ```
+     */
+    std::string directory = {};
+};
+
 
 /**
  * @brief Allocator: 给⬇️游分配 POSIX shared memory.
@@ -861,7 +1679,7 @@ class ShM_Resource: public std::pmr::memory_resource {
 #ifdef IPCATOR_IS_BEING_DOXYGENING  // stupid doxygen
         /**
          * @brief 分配 POSIX shared memory.
-         * @param alignment 对齐要求.
+         * @param alignment 对齐要求.  可以是任意 2 的幂, 包括超过📄页面大小的值.
          * @details 新建 `Shared_Memory<true>`, 不作任何切分,
          *          因此这是粒度最粗的分配器.
          * @return `Shared_Memory<true>` 的 `std::data` 值.
@@ -872,6 +1690,15 @@ class ShM_Resource: public std::pmr::memory_resource {
          *      allocator = ShM_Resource<std::unordered_set>{};
          *      _ = allocator.allocate(56), _ = allocator.allocate(78, 16);
          * ```
+         * @note example (超过📄页面大小的对齐要求):
+         * ```
+         * auto allocator = ShM_Resource<std::unordered_set>{};
+         * auto area = allocator.allocate(100, 2uz << 20);
+         * assert( std::uintptr_t(area) % (2uz << 20) == 0 );
+         * assert( std::data(allocator.find_arena(area)) == area );
+         * allocator.deallocate(area, 100, 2uz << 20);
+         * assert( std::empty(allocator.get_resources()) );
+         * ```
          */
         void *allocate(
             std::size_t size, std::size_t alignment = alignof(std::max_align_t)
@@ -906,29 +1733,11 @@ class ShM_Resource: public std::pmr::memory_resource {
                   (false)
 #endif
         [[clang::lifetimebound]] override {
-            if (alignment > ::getpagesize() + 0u) [[unlikely]] {
-                struct TooLargeAlignment: std::bad_alloc {
-                    const std::string message;
-                    TooLargeAlignment(const std::size_t demanded_alignment)
-                    : message{
-                        std::format(
-                            "请求分配的字节数组要求按 {} 对齐, 超出了页表大小 (即 {}).",
-                            demanded_alignment,
-                            ::getpagesize()
-                        )
-                    } {}
-                    const char *what() const noexcept override {
-                        return this->message.c_str();
-                    }
-                };
-#ifndef IPCATOR_OFAST
-                throw TooLargeAlignment{alignment};
-#endif
-            }
-
+            // 不超过📄页面大小的对齐要求由 mmap 天然满足; 更大的
+            // 则由 `Shared_Memory` 选取对齐的位置来映射.
             const auto [inserted, ok] = this->resources.emplace(
-                generate_shm_UUName(),
-                size
+                this->directory + generate_shm_UUName(),
+                size, alignment
             );
             assert(ok);
 #if __has_cpp_attribute(assume)
@@ -959,8 +1768,8 @@ class ShM_Resource: public std::pmr::memory_resource {
             IPCATOR_LOG_ALLO_OR_DEALLOC("red");
 
             // 标准要求 allocation 与 deallocation 的 ‘alignment’ 要匹配, 否则是 undefined
-            // behavior.  我们没有记录 allocation 的 ‘alignment’ 值是多少, 但肯定不比📄页面大.
-            assert(alignment <= ::getpagesize() + 0u);
+            // behavior.  我们没有记录 allocation 的 ‘alignment’ 值是多少, 但 ‘area’ 肯定按它对齐.
+            assert(std::uintptr_t(area) % alignment == 0);
 
             const auto whatcanisay_shm_out = std::move(
                 this->resources
@@ -1002,11 +1811,78 @@ class ShM_Resource: public std::pmr::memory_resource {
          * @brief 构造函数.
          */
         ShM_Resource() noexcept = default;
+        /**
+         * @brief 构造函数.  若 `options.manifest` 所指的 manifest 存在, 则接管其中
+         *        记录的所有 POSIX shared memory.
+         * @note 接管时, 若某个 POSIX shared memory 已不存在 (例如被手动删除了), 会
+         *       等待至多 1s, 然后跳过它.
+         * @note example (模拟进程重启):
+         * ```
+         * std::string name;
+         * {
+         *     auto writer = ShM_Resource<std::set>{{.manifest = "/ipcator.manifest"}};
+         *     auto area = (char *)writer.allocate(100, 64uz << 10);
+         *     area[42] = 42;
+         *     name = writer.find_arena(area).get_name();
+         * }  // 有序退出: 记入 manifest, 并且不 unlink.
+         * auto restarted = ShM_Resource<std::unordered_set>{{.manifest = "/ipcator.manifest"}};
+         * assert( std::size(restarted.get_resources()) == 1 );
+         * auto& shm = *std::cbegin(restarted.get_resources());
+         * assert( shm.get_name() == name && shm[42] == 42 );
+         * assert( std::uintptr_t(std::data(shm)) % (64uz << 10) == 0 );
+         * restarted.discard_manifest();  // 不再需要持久化了.
+         * ```
+         */
+        explicit ShM_Resource(const ShM_Resource_Options& options)
+        : manifest{options.manifest}, directory{options.directory} {
+            assert(std::empty(this->directory) || this->directory.front() == '/');
+
+            if (std::empty(this->manifest))
+                return;
+
+            // 先判断 manifest 是否存在, 以免 accessor 白白等待:
+            if (const auto fd = POSIX::shm_open(this->manifest, O_RDONLY, 0); fd == -1)
+                return;
+            else
+                ::close(fd);
+
+            const auto record = Shared_Memory{this->manifest};
+            const auto& header = *(const Manifest_Header *)std::data(record);
+            if (
+                std::size(record) < sizeof(Manifest_Header)
+                || header.magic != Manifest_Header::expected_magic
+                || std::size(record) < sizeof(Manifest_Header) + header.count * sizeof(Manifest_Entry)
+            )
+                throw std::invalid_argument{"‘" + this->manifest + "’ 不是合法的 manifest"};
+
+            for (const auto& entry : std::span{
+                (const Manifest_Entry *)(std::data(record) + sizeof(Manifest_Header)),
+                header.count
+            })
+                try {
+                    const auto [inserted, ok] = this->resources.emplace(
+                        std::adopt_lock, std::data(entry.name), entry.alignment
+                    );
+                    assert(ok);
+                    if constexpr (!using_ordered_set)
+                        this->last_inserted = std::to_address(
+#if _GLIBCXX_RELEASE == 10  // GCC 的 bug, 见 ipcator#2.
+                            &*
+#endif
+                            inserted
+                        );
+                } catch (const std::filesystem::filesystem_error&) {
+#ifdef IPCATOR_LOG
+                    std::clog << std::format("manifest 中的 ‘{}’ 已不存在.\n", std::data(entry.name));
+#endif
+                }
+        }
         /**
          * @brief 实现移动语义.
          */
         ShM_Resource(ShM_Resource&& other) noexcept
-        : resources{std::move(other.resources)} {
+        : resources{std::move(other.resources)},
+          manifest{std::move(other.manifest)}, directory{std::move(other.directory)} {
             if constexpr (!using_ordered_set)
                 this->last_inserted = std::move(other.last_inserted);
         }
@@ -1015,6 +1891,8 @@ class ShM_Resource: public std::pmr::memory_resource {
          */
         friend void swap(ShM_Resource& a, decltype(a) b) noexcept {
             std::swap(a.resources, b.resources);
+            std::swap(a.manifest, b.manifest);
+            std::swap(a.directory, b.directory);
 
             if constexpr (!using_ordered_set)
                 std::swap(a.last_inserted, b.last_inserted);
@@ -1038,6 +1916,7 @@ class ShM_Resource: public std::pmr::memory_resource {
             return *this;
         }
         ~ShM_Resource() override {
+            this->commit_manifest(std::nothrow);
 #ifdef IPCATOR_LOG  // 显式删除以触发日志输出.
                 while (!std::empty(this->resources)) {
                     auto& area = *std::cbegin(this->resources);
@@ -1048,6 +1927,84 @@ class ShM_Resource: public std::pmr::memory_resource {
 #endif
         }
 
+        /**
+         * @brief 若开启了持久化, 将当前所有的 `Shared_Memory<true>` 记入 manifest, 并令它们
+         *        在析构时不被 unlink.  此后不再维护 manifest, 即关闭持久化.
+         * @details 析构时会自动调用.
+         * @see ShM_Resource_Options::manifest
+         */
+        void commit_manifest [[gnu::cold]] () {
+            if (std::empty(this->manifest))
+                return;
+            const auto manifest = std::exchange(this->manifest, {});
+
+            // 先写到临时的名字下, 再原子地替换旧的 manifest (如有), 使得任何时刻崩溃,
+            // 都总有一份完整的 manifest:
+            const auto staging = manifest + ".tmp";
+            POSIX::shm_unlink(staging);  // 上次中途崩溃的残留 (如有).
+            {
+                auto record = Shared_Memory{
+                    staging,
+                    sizeof(Manifest_Header) + std::size(this->resources) * sizeof(Manifest_Entry)
+                };
+                record.persist();
+
+                auto& header = *new(std::data(record)) Manifest_Header{
+                    .magic = Manifest_Header::expected_magic,
+                    .count = std::size(this->resources),
+                };
+                auto entry = (Manifest_Entry *)(std::data(record) + sizeof(header));
+                for (const auto& shm : this->resources) {
+                    const auto alignment = shm.get_alignment();
+                    assert(std::size(shm.get_name()) < std::size(entry->name));
+
+                    auto& e = *new(entry++) Manifest_Entry{
+                        .alignment = alignment > ::getpagesize() + 0u ? alignment : 0,
+                        .name = {},
+                    };
+                    std::ranges::copy(shm.get_name(), std::begin(e.name));
+                }
+                if (POSIX::is_file_path(staging))
+                    record.sync();
+            }
+            if (POSIX::shm_rename(staging, manifest) == -1) {
+                const auto error = errno;
+                POSIX::shm_unlink(staging);
+                throw std::filesystem::filesystem_error{
+                    "无法替换 manifest", staging, manifest, {error, std::generic_category()}
+                };
+            }
+
+            // manifest 已就位, 才令它记录的 POSIX shared memory 不被 unlink:
+            for (const auto& shm : this->resources)
+                // 集合中的元素是 const 的, 但该标志并不影响元素在集合中的位置:
+                const_cast<Shared_Memory<true>&>(shm).persist();
+        }
+        /**
+         * @brief 同上, 但失败时 (例如无法创建 manifest) 不抛出异常, 而是放弃持久化: 所有
+         *        `Shared_Memory<true>` 照常在析构时被 unlink.
+         * @return 是否成功.
+         */
+        bool commit_manifest [[gnu::cold]] (std::nothrow_t) noexcept {
+            try {
+                this->commit_manifest();
+                return true;
+            } catch (const std::exception& e) {
+                // 失败发生在 manifest 就位之前, 因此这些 POSIX shared memory 都不会被保留,
+                // 旧的 manifest (如有) 也保持原样:
+                std::clog << std::format("记入 manifest 失败, 放弃持久化: {}\n", e.what());
+                return false;
+            }
+        }
+        /**
+         * @brief 关闭持久化, 并删除 manifest.  此后, 与普通的 `ShM_Resource` 一样,
+         *        `Shared_Memory<true>` 析构时会被 unlink.
+         */
+        void discard_manifest [[gnu::cold]] () noexcept {
+            if (!std::empty(this->manifest))
+                POSIX::shm_unlink(std::exchange(this->manifest, {}));
+        }
+
         /**
          * @brief 获取 `Shared_Memory<true>` 的集合的引用.
          * @details 它包含了所有已分配而未回收的 `Shared_Memory<true>`.
@@ -1125,7 +2082,7 @@ class ShM_Resource: public std::pmr::memory_resource {
             ));
 
             return resources;
-        }()} {}
+        }()}, manifest{std::move(other.manifest)}, directory{std::move(other.directory)} {}
 
         /**
          * @brief 将 self 以类似 JSON 的格式输出.
@@ -1191,6 +2148,18 @@ class ShM_Resource: public std::pmr::memory_resource {
         }
         private:
             friend struct std::formatter<ShM_Resource>;
+            template <template <typename... T> class> friend class ShM_Resource;
+
+            std::string manifest, directory;
+            struct Manifest_Header {
+                static constexpr std::array<char, 8> expected_magic{'i', 'p', 'c', 'a', 't', 'o', 'r', '2'};
+                std::array<char, 8> magic;
+                std::size_t count;
+            };
+            struct Manifest_Entry {
+                std::size_t alignment;
+                std::array<char, PATH_MAX> name;
+            };
             std::conditional_t<
                 !using_ordered_set,
                 const Shared_Memory<true> *, std::monostate
@@ -1298,15 +2267,30 @@ struct Monotonic_ShM_Buffer: std::pmr::monotonic_buffer_resource {
          *       (该构造函数会自动将 `initial_size` 用  `ceil_to_page_size(const std::size_t)`
          *       向上取整.)
          * @warning `initial_size` 不可为 0.
+         * @param isolate_cache_lines 是否将每个内存块的大小和对齐都扩充到
+         *                            `cache_line_size`, 使不同内存块绝不共享
+         *                            缓存行.  当不同进程分别频繁读写相邻的
+         *                            内存块时, 这能避免跨核的 false sharing.
+         * @param upstream_options ⬆️游的配置选项.  不支持持久化 (buffer 的簿记
+         *                         信息无法在重启后恢复), 即 `manifest` 必须为空
+         *                         (否则被忽略).
          */
-        Monotonic_ShM_Buffer(const std::size_t initial_size = 1)
+        Monotonic_ShM_Buffer(
+            const std::size_t initial_size = 1, const bool isolate_cache_lines = false,
+            const ShM_Resource_Options& upstream_options = {}
+        )
 #ifdef IPCATOR_OFAST
         noexcept
 #endif
         : monotonic_buffer_resource{
             ceil_to_page_size(initial_size),
-            new ShM_Resource<std::unordered_set>,
-        } {
+            new ShM_Resource<std::unordered_set>{[&] {
+                assert(std::empty(upstream_options.manifest));
+                auto options = upstream_options;
+                options.manifest.clear();
+                return options;
+            }()},
+        }, isolate_cache_lines{isolate_cache_lines} {
             assert(initial_size);
 #if __has_cpp_attribute(assume)
             [[assume(initial_size)]];
@@ -1335,18 +2319,67 @@ struct Monotonic_ShM_Buffer: std::pmr::monotonic_buffer_resource {
                 this->monotonic_buffer_resource::upstream_resource()
             );
         }
+
+        /**
+         * @brief 强制释放所有已分配而未收回的内存, 并清零 `cache_line_stats`.
+         * @details 将当前缓冲区和下个缓冲区的大小设置为其构造时的
+         *          `initial_size`.
+         * @note 内存的释放仅代表 `Shared_Memory<true>` 的析构, 因此
+         *       其它进程仍可能从这些内存中读取消息.  (See
+         *       `Shared_Memory::~Shared_Memory()`.)
+         * @warning 它隐藏而非覆盖了基类的 `release` (后者不是虚函数), 经由
+         *          `std::pmr::monotonic_buffer_resource` 的指针或引用调用时,
+         *          内存照常释放, 但统计不会清零.
+         */
+        void release() {
+            this->monotonic_buffer_resource::release();
+            this->num_allocations.store(0, std::memory_order_relaxed);
+            this->num_sharing.store(0, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief 统计 (自上次 `release` 以来) 的 allocation 中, 有多少个内存块可能与相邻
+         *        的内存块共享缓存行.
+         * @note example:
+         * ```
+         * auto packed = Monotonic_ShM_Buffer{};
+         * auto _ = packed.allocate(8); _ = packed.allocate(8);
+         * assert( packed.cache_line_stats().allocations == 2 );
+         * assert( packed.cache_line_stats().sharing == 2 );
+         * packed.release();
+         * assert( packed.cache_line_stats().allocations == 0 );
+         * auto isolated = Monotonic_ShM_Buffer{1, true};
+         * auto a = (char *)isolated.allocate(8), b = (char *)isolated.allocate(8);
+         * assert( b - a >= (std::ptrdiff_t)cache_line_size );
+         * assert( isolated.cache_line_stats().sharing == 0 );
+         * ```
+         */
+        auto cache_line_stats [[gnu::cold]] () const noexcept {
+            return Cache_Line_Stats{
+                .allocations = this->num_allocations.load(std::memory_order_relaxed),
+                .sharing = this->num_sharing.load(std::memory_order_relaxed),
+            };
+        }
     protected:
         void *do_allocate [[using gnu: hot, returns_nonnull, alloc_size(2)]] (
-            const std::size_t size, const std::size_t alignment
+            std::size_t size, std::size_t alignment
         )
 #ifdef IPCATOR_OFAST
           noexcept
 #endif
           override {
+            if (this->isolate_cache_lines)
+                size = ceil_to_cache_line_size(size),
+                alignment = std::max(alignment, cache_line_size);
+
             const auto area = this->monotonic_buffer_resource::do_allocate(
                 size, alignment
             );
             IPCATOR_LOG_ALLO_OR_DEALLOC("green");
+
+            this->num_allocations.fetch_add(1, std::memory_order_relaxed);
+            if (std::uintptr_t(area) % cache_line_size || size % cache_line_size)
+                this->num_sharing.fetch_add(1, std::memory_order_relaxed);
             return area;
         }
         void do_deallocate [[gnu::nonnull(2)]] (
@@ -1361,15 +2394,6 @@ struct Monotonic_ShM_Buffer: std::pmr::monotonic_buffer_resource {
             this->monotonic_buffer_resource::do_deallocate(area, size, alignment);
         }
 #ifdef IPCATOR_IS_BEING_DOXYGENING  // stupid doxygen
-        /**
-         * @brief 强制释放所有已分配而未收回的内存.
-         * @details 将当前缓冲区和下个缓冲区的大小设置为其构造时的
-         *          `initial_size`.
-         * @note 内存的释放仅代表 `Shared_Memory<true>` 的析构, 因此
-         *       其它进程仍可能从这些内存中读取消息.  (See
-         *       `Shared_Memory::~Shared_Memory()`.)
-         */
-        void release();
         /**
          * @brief 从某片 POSIX shared memory 区域中划出一块分配.
          * @param alignment 可选.
@@ -1377,6 +2401,12 @@ struct Monotonic_ShM_Buffer: std::pmr::monotonic_buffer_resource {
          *          获取新的 `Shared_Memory<true>` (每次向⬆️游申请
          *          的 shared memory 的大小以几何级数增加) 加入到
          *          剩余空间中.  然后, 从剩余空间中从中划出一块.
+         * @note example (按 64 KiB 对齐):
+         * ```
+         * auto buffer = Monotonic_ShM_Buffer{};
+         * auto addr = buffer.allocate(1000, 64uz << 10);
+         * assert( std::uintptr_t(addr) % (64uz << 10) == 0 );
+         * ```
          */
         void *allocate(
             std::size_t size, std::size_t alignment = alignof(std::max_align_t)
@@ -1389,6 +2419,9 @@ struct Monotonic_ShM_Buffer: std::pmr::monotonic_buffer_resource {
          */
         void deallocate(void *area) = delete;
 #endif
+    private:
+        const bool isolate_cache_lines;
+        std::atomic_size_t num_allocations{}, num_sharing{};
 };
 
 
@@ -1423,39 +2456,67 @@ class ShM_Pool: public std::conditional_t<
             std::pmr::synchronized_pool_resource,
             std::pmr::unsynchronized_pool_resource
         >;
+        const bool isolate_cache_lines;
+        std::atomic_size_t num_allocations{}, num_sharing{};
     protected:
         void *do_allocate [[using gnu: hot, returns_nonnull, alloc_size(2)]] (
-            const std::size_t size, const std::size_t alignment
+            std::size_t size, std::size_t alignment
         )
 #ifdef IPCATOR_OFAST
           noexcept
 #endif
           override {
+            if (this->isolate_cache_lines)
+                size = ceil_to_cache_line_size(size),
+                alignment = std::max(alignment, cache_line_size);
+
             const auto area = this->midstream_pool_t::do_allocate(
                 size, alignment
             );
             IPCATOR_LOG_ALLO_OR_DEALLOC("green");
+
+            this->num_allocations.fetch_add(1, std::memory_order_relaxed);
+            if (std::uintptr_t(area) % cache_line_size || size % cache_line_size)
+                this->num_sharing.fetch_add(1, std::memory_order_relaxed);
             return area;
         }
 
         void do_deallocate [[gnu::nonnull(2)]] (
             void *const area [[clang::noescape]],
-            const std::size_t size,
-            const std::size_t alignment
+            std::size_t size,
+            std::size_t alignment
         )
 #ifdef IPCATOR_OFAST
           noexcept
 #endif
           override {
+            // 必须与 allocation 时的 ‘size’ 和 ‘alignment’ 一致:
+            if (this->isolate_cache_lines)
+                size = ceil_to_cache_line_size(size),
+                alignment = std::max(alignment, cache_line_size);
+
             IPCATOR_LOG_ALLO_OR_DEALLOC("red");
             this->midstream_pool_t::do_deallocate(area, size, alignment);
+
+            this->num_allocations.fetch_sub(1, std::memory_order_relaxed);
+            if (std::uintptr_t(area) % cache_line_size || size % cache_line_size)
+                this->num_sharing.fetch_sub(1, std::memory_order_relaxed);
         }
     public:
         /**
          * @brief 构造 pools.
          * @param options 设定: 最大的 block size, 每 chunk 的最大 blocks 数量.
+         * @param isolate_cache_lines 是否将每个 block 的大小和对齐都扩充到 `cache_line_size`,
+         *                            使不同 blocks 绝不共享缓存行, 以避免跨进程的 false sharing.
+         * @param upstream_options ⬆️游的配置选项.  不支持持久化 (池子的簿记信息位于私有
+         *                         内存, 无法在重启后恢复), 即 `manifest` 必须为空 (否则
+         *                         被忽略).
          */
-        ShM_Pool(const std::pmr::pool_options& options = {.largest_required_pool_block=1}) noexcept
+        ShM_Pool(
+            const std::pmr::pool_options& options = {.largest_required_pool_block=1},
+            const bool isolate_cache_lines = false,
+            const ShM_Resource_Options& upstream_options = {}
+        )
         : midstream_pool_t{
             decltype(options){
                 .max_blocks_per_chunk = options.max_blocks_per_chunk,
@@ -1463,8 +2524,13 @@ class ShM_Pool: public std::conditional_t<
                     options.largest_required_pool_block
                 ),  // 向⬆️游申请内存的🚪≥页表大小, 避免零碎的请求.
             },
-            new ShM_Resource<std::set>,
-        } {}
+            new ShM_Resource<std::set>{[&] {
+                assert(std::empty(upstream_options.manifest));
+                auto options = upstream_options;
+                options.manifest.clear();
+                return options;
+            }()},
+        }, isolate_cache_lines{isolate_cache_lines} {}
         ~ShM_Pool() override {
             this->release();
             delete this->midstream_pool_t::upstream_resource();
@@ -1490,6 +2556,48 @@ class ShM_Pool: public std::conditional_t<
             );
         }
 
+        /**
+         * @brief 强制释放所有已分配而未收回的内存, 并清零 `cache_line_stats`.
+         * @note 内存的释放仅代表 `Shared_Memory<true>` 的析构, 因此
+         *       其它进程仍可能从这些内存中读取消息.  (See
+         *       `Shared_Memory::~Shared_Memory()`.)
+         * @note example:
+         * ```
+         * auto pools = ShM_Pool<false>{};
+         * auto _ = pools.allocate(1);
+         * assert( std::size(pools.upstream_resource()->get_resources()) );
+         * pools.release();
+         * assert( std::size(pools.upstream_resource()->get_resources()) == 0 );
+         * ```
+         * @warning 它隐藏而非覆盖了基类的 `release` (后者不是虚函数), 经由
+         *          `std::pmr::*_pool_resource` 的指针或引用调用时, 内存照常释放,
+         *          但统计不会清零.
+         */
+        void release() {
+            this->midstream_pool_t::release();
+            this->num_allocations.store(0, std::memory_order_relaxed);
+            this->num_sharing.store(0, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief 统计尚未回收的 blocks 中, 有多少个可能与相邻的 block 共享缓存行.
+         * @note example:
+         * ```
+         * auto pools = ShM_Pool<true>{{}, true};
+         * auto a = pools.allocate(4), b = pools.allocate(4);
+         * assert( pools.cache_line_stats().allocations == 2 );
+         * assert( pools.cache_line_stats().sharing == 0 );
+         * pools.deallocate(a, 4), pools.deallocate(b, 4);
+         * assert( pools.cache_line_stats().allocations == 0 );
+         * ```
+         */
+        auto cache_line_stats [[gnu::cold]] () const noexcept {
+            return Cache_Line_Stats{
+                .allocations = this->num_allocations.load(std::memory_order_relaxed),
+                .sharing = this->num_sharing.load(std::memory_order_relaxed),
+            };
+        }
+
 #ifdef IPCATOR_IS_BEING_DOXYGENING  // stupid doxygen
         /**
          * @brief 查看构造时指定的配置选项的实际值.
@@ -1510,21 +2618,6 @@ class ShM_Pool: public std::conditional_t<
          * ```
          */
         std::pmr::pool_options options() const;
-        /**
-         * @brief 强制释放所有已分配而未收回的内存.
-         * @note 内存的释放仅代表 `Shared_Memory<true>` 的析构, 因此
-         *       其它进程仍可能从这些内存中读取消息.  (See
-         *       `Shared_Memory::~Shared_Memory()`.)
-         * @note example:
-         * ```
-         * auto pools = ShM_Pool<false>{};
-         * auto _ = pools.allocate(1);
-         * assert( std::size(pools.upstream_resource()->get_resources()) );
-         * pools.release();
-         * assert( std::size(pools.upstream_resource()->get_resources()) == 0 );
-         * ```
-         */
-        void release();
         /**
          * @brief 从共享内存中分配 block.
          * @param alignment 对齐要求.
@@ -1588,9 +2681,36 @@ static_assert(
  *          大小, 以限制自身占用的资源.  然而, 即使
  *          缓存被清空, 只要持有 `read` 方法的返回值
  *          (迭代器) 就能保证仍能访问对应的消息.
+ *          若 writer 会以同名重建共享内存, 可令其
+ *          定期检查缓存是否过时, 见构造函数.
  */
 template <auto writable=false>
 struct ShM_Reader {
+        ShM_Reader() = default;
+        /**
+         * @param stale_check_interval 每个名字每被 `read` `stale_check_interval` 次 (命中缓存),
+         *                             就检查一次它是否已被重建 (见 `Shared_Memory::is_stale`),
+         *                             是则丢弃旧的映射并重新映射.  0 表示从不检查.
+         * @details 对沿用固定名字的 writer (unlink 后以同名重建), 这使得 reader 可以
+         *          长期持有缓存, 而不必每次都防御性地重新打开.  已返回的迭代器继续
+         *          引用旧对象, 不受重新映射的影响.
+         * @note example:
+         * ```
+         * auto writer = std::optional<Shared_Memory<true>>{{"/ipcator.reused", 64}};
+         * (*writer)[0] = 1;
+         * auto rd = ShM_Reader{1};
+         * auto old = rd.template read<char>("/ipcator.reused", 0);
+         * assert( *old == 1 );
+         * writer.reset();
+         * writer.emplace("/ipcator.reused", 64);
+         * (*writer)[0] = 2;
+         * assert( *rd.template read<char>("/ipcator.reused", 0) == 2 );
+         * assert( *old == 1 );
+         * ```
+         */
+        explicit ShM_Reader(const std::size_t stale_check_interval) noexcept
+        : stale_check_interval{stale_check_interval} {}
+
         /**
          * @brief 以 迭代器/智能指针 的形式获取消息的引用,
          *        在迭代器析构之前, **保证** 可以访问消息.
@@ -1634,6 +2754,8 @@ struct ShM_Reader {
                         return (element_type *)(this->shm->data() + this->offset);
                     }
                     auto& operator*() const { return *this->operator->(); }
+                    /* 消息所在的共享内存. */
+                    auto& arena() const noexcept { return *this->shm; }
 #ifdef IPCATOR_USED_BY_SEER_RBK
                     auto cnt_ref_shm() const { return this->shm.use_count(); }
 #endif
@@ -1642,6 +2764,179 @@ struct ShM_Reader {
             return Iterator{this->select_shm(shm_name), offset};
         }
 
+        /**
+         * @brief 一批已解析的消息.  持有它们所在的共享内存的引用, 因此在
+         *        `Batch` 析构之前, **保证** 可以访问这些消息.
+         * @details 遍历时, 会在消费者的当前位置之前 `prefetch_distance`
+         *          个消息处发出软件预取, 使访存延迟与对消息的处理重叠.
+         * @see ShM_Reader::read_batch, ShM_Reader::read_ahead
+         */
+        template <class T>
+        class Batch {
+                friend ShM_Reader;
+            public:
+                using element_type = std::conditional_t<writable, T, const T>;
+            private:
+                std::vector<std::shared_ptr<const Shared_Memory<false, writable>>> segments;
+                std::vector<element_type *> views;
+                std::size_t prefetch_distance = 0;
+
+                static void prefetch [[gnu::always_inline]] (const element_type *const view) noexcept {
+                    for (auto line = 0uz; line < sizeof(T); line += cache_line_size)
+                        __builtin_prefetch((const char *)view + line, writable, 3);
+                }
+            public:
+                class iterator {
+                        element_type *const *pos = nullptr, *const *last = nullptr;
+                        std::size_t prefetch_distance = 0;
+                        friend Batch;
+                        iterator(
+                            element_type *const *const pos, element_type *const *const last,
+                            const std::size_t prefetch_distance
+                        ) noexcept: pos{pos}, last{last}, prefetch_distance{prefetch_distance} {}
+                    public:
+                        using iterator_category = std::forward_iterator_tag;
+                        using iterator_concept = std::forward_iterator_tag;
+                        using value_type = std::remove_cv_t<T>;
+                        using difference_type = std::ptrdiff_t;
+                        iterator() noexcept = default;
+                        auto& operator*() const noexcept { return **this->pos; }
+                        auto *operator->() const noexcept { return *this->pos; }
+                        auto& operator++() noexcept {
+                            ++this->pos;
+                            // `begin` 已预取了前 `prefetch_distance` 个, 此后每前进一步
+                            // 就预取窗口末尾新进入的那一个:
+                            if (this->prefetch_distance && this->last - this->pos >= std::ptrdiff_t(this->prefetch_distance))
+                                prefetch(this->pos[this->prefetch_distance - 1]);
+                            return *this;
+                        }
+                        auto operator++(int) noexcept { auto old = *this; ++*this; return old; }
+                        bool operator==(const iterator& other) const noexcept { return this->pos == other.pos; }
+                };
+                auto begin() const noexcept {
+                    for (const auto view : this->views | std::views::take(this->prefetch_distance))
+                        prefetch(view);
+                    return iterator{std::data(this->views), std::data(this->views) + std::size(this->views), this->prefetch_distance};
+                }
+                auto end() const noexcept {
+                    const auto last = std::data(this->views) + std::size(this->views);
+                    return iterator{last, last, this->prefetch_distance};
+                }
+                auto size() const noexcept { return std::size(this->views); }
+                auto& operator[](const std::size_t i) const noexcept { return *this->views[i]; }
+        };
+
+        /**
+         * @brief 一次性解析一批消息的位置.
+         * @param descriptors 由 (共享内存的名字, 偏移量) 组成的序列.  名字可以是
+         *                    `std::string{,_view}` 或以 NULL 结尾的字符数组.
+         * @details 先将 `descriptors` 按共享内存的名字排序并分组, 每组只查询 (必要时
+         *          映射) 一次共享内存, 且只持有一份它的引用.  因此开销取决于不同的
+         *          共享内存的数量, 而非消息的数量.  返回的 `Batch` 中, 消息的顺序与
+         *          `descriptors` 的一致.
+         * @note example:
+         * ```
+         * using namespace literals;
+         * auto a = "/ipcator.batch-a"_shm[100], b = "/ipcator.batch-b"_shm[100];
+         * a[0] = 'a', a[1] = 'A', b[0] = 'b';
+         * auto rd = ShM_Reader{};
+         * const std::pair<std::string_view, std::size_t> descriptors[] = {
+         *     {"/ipcator.batch-a", 0}, {"/ipcator.batch-b", 0}, {"/ipcator.batch-a", 1},
+         * };
+         * auto batch = rd.template read_batch<char>(descriptors);
+         * assert( std::size(batch) == 3 );
+         * assert( batch[0] == 'a' && batch[1] == 'b' && batch[2] == 'A' );
+         * ```
+         */
+        template <class T>
+        auto read_batch [[gnu::hot]] (const std::ranges::forward_range auto& descriptors)
+        requires std::is_object_v<T> && std::is_lvalue_reference_v<
+            std::ranges::range_reference_t<decltype(descriptors)>
+        > {
+            std::vector<std::pair<std::string_view, std::size_t>> locations;
+            for (const auto& [name, offset] : descriptors)
+                locations.emplace_back(ShM_Reader::as_shm_name(name), offset);
+
+            // 间接排序, 以保留原有的顺序:
+            std::vector<std::size_t> order(std::size(locations));
+            std::iota(std::begin(order), std::end(order), 0uz);
+            std::ranges::stable_sort(order, {}, [&](const auto i) { return locations[i].first; });
+
+            Batch<T> batch;
+            batch.views.resize(std::size(locations));
+            for (auto group = std::cbegin(order); group != std::cend(order); ) {
+                const auto name = locations[*group].first;
+                const auto& shm = batch.segments.emplace_back(this->select_shm(name));
+                for (; group != std::cend(order) && locations[*group].first == name; ++group)
+                    batch.views[*group] = (typename Batch<T>::element_type *)(
+                        std::data(*shm) + locations[*group].second
+                    );
+            }
+            return batch;
+        }
+
+        /**
+         * @brief 解析一批消息的位置, 并在遍历时提前预取.
+         * @param descriptors 同 `ShM_Reader::read_batch`.
+         * @param prefetch_distance 预取领先于消费者的消息数.  0 表示不预取.
+         * @param will_need 是否额外调用 `madvise(MADV_WILLNEED)`, 提示 kernel 提前
+         *                  准备好这些消息所在的 (可能是冷的) 📄页面.
+         * @note example:
+         * ```
+         * using namespace literals;
+         * auto shm = "/ipcator.batch"_shm[4096];
+         * for (auto i : std::views::iota(0, 8))
+         *     new(&shm[i * 64]) int{i};
+         * auto rd = ShM_Reader{};
+         * std::vector<std::pair<std::string, std::size_t>> descriptors;
+         * for (auto i : std::views::iota(0uz, 8uz))
+         *     descriptors.emplace_back("/ipcator.batch", i * 64);
+         * auto sum = 0;
+         * for (auto& n : rd.template read_ahead<int>(descriptors, 4, true))
+         *     sum += n;
+         * assert( sum == 28 );
+         * assert( std::ranges::max(rd.template read_ahead<int>(descriptors, 4)) == 7 );  // 可用于标准算法.
+         * ```
+         */
+        template <class T>
+        auto read_ahead [[gnu::hot]] (
+            const std::ranges::forward_range auto& descriptors,
+            const std::size_t prefetch_distance = 8, const bool will_need = false
+        ) requires requires { this->template read_batch<T>(descriptors); } {
+            auto batch = this->template read_batch<T>(descriptors);
+            batch.prefetch_distance = prefetch_distance;
+
+            if (will_need) {
+                // 合并相邻的📄页面, 减少系统调用的次数:
+                auto advised_begin = std::uintptr_t{}, advised_end = std::uintptr_t{};
+                const auto advise = [&] {
+                    if (advised_begin != advised_end)
+                        ::madvise((void *)advised_begin, advised_end - advised_begin, MADV_WILLNEED);
+                };
+                for (const auto view : batch.views) {
+                    const auto page_begin = std::uintptr_t(view) / ::getpagesize() * ::getpagesize(),
+                               page_end = ceil_to_page_size(std::uintptr_t(view) + sizeof(T));
+                    if (advised_begin <= page_begin && page_begin <= advised_end)
+                        advised_end = std::max(advised_end, page_end);
+                    else
+                        advise(), advised_begin = page_begin, advised_end = page_end;
+                }
+                advise();
+            }
+            return batch;
+        }
+
+        /**
+         * @brief 缓存中是否已有 `shm_name` 的映射.  若有, `read` 它时不会打开目标文件.
+         */
+        bool contains(const std::string_view shm_name) const noexcept {
+#ifdef __cpp_lib_generic_unordered_lookup
+            return this->cache.contains(shm_name);
+#else
+            return std::ranges::any_of(this->cache, [&](const auto& shm) { return ShM_As_Str{}(shm_name, shm); });
+#endif
+        }
+
         /**
          * @brief 保留任何被由 `read` 返回的迭代器所引用的消息
          *        所在的共享内存, 缓存中其余的共享内存实例将被释放.
@@ -1650,25 +2945,48 @@ struct ShM_Reader {
         auto gc_ [[gnu::cold]] () noexcept {
             return std::erase_if(
                 this->cache,
-                [](const auto& shm)
+                [](const auto& cached)
 #ifdef __cpp_static_call_operator
                 static
 #endif
                 {
                     return
 #if __cplusplus <= 201703L
-                        shm.unique()
+                        cached.shm.unique()
 #else
-                        shm.use_count() == 1
+                        cached.shm.use_count() == 1
 #endif
                     ;
                 }
             );
         }
 
+        /**
+         * @brief 立即检查缓存中的所有共享内存, 丢弃其中名字已被重建的; 下次 `read`
+         *        它们时再重新映射.
+         * @return 丢弃的 `Shared_Memory<false, writable>` 的数量.
+         * @note example:
+         * ```
+         * auto writer = std::optional<Shared_Memory<true>>{{"/ipcator.refresh", 8}};
+         * auto rd = ShM_Reader{};
+         * (void)rd.template read<char>("/ipcator.refresh", 0);
+         * auto dropped = rd.refresh();
+         * assert( dropped == 0 );
+         * writer.reset();
+         * writer.emplace("/ipcator.refresh", 8);
+         * (*writer)[3] = 3;
+         * dropped = rd.refresh();
+         * assert( dropped == 1 );
+         * assert( *rd.template read<char>("/ipcator.refresh", 3) == 3 );
+         * ```
+         */
+        auto refresh [[gnu::cold]] () noexcept {
+            return std::erase_if(this->cache, [](const auto& cached) { return cached->is_stale(); });
+        }
+
         auto select_shm(const std::string_view name) {
             if (
-                const auto pshm =
+                auto pshm =
 #ifdef __cpp_lib_generic_unordered_lookup
                     this->cache.find(name)
 #else
@@ -1682,9 +3000,18 @@ struct ShM_Reader {
 #endif
                 ;
                 pshm != std::cend(this->cache)
-            )
-                return *pshm;
-            else {
+            ) {
+                if (
+                    !this->stale_check_interval
+                    || ++pshm->hits_since_stale_check < this->stale_check_interval
+                ) [[likely]]
+                    return pshm->shm;
+                pshm->hits_since_stale_check = 0;
+                if (!pshm->shm->is_stale())
+                    return pshm->shm;
+                this->cache.erase(pshm);  // 旧对象仍由已返回的迭代器持有.
+            }
+            {
                 const auto [inserted, ok] = this->cache.emplace(
                     std::make_shared<Shared_Memory<false, writable>>(std::string{name})
                 );
@@ -1692,10 +3019,17 @@ struct ShM_Reader {
 #if __has_cpp_attribute(assume)
                 [[assume(ok)]];
 #endif
-                return *inserted;
+                return inserted->shm;
             }
         }
     private:
+        static auto as_shm_name(const auto& name) -> std::string_view {
+            if constexpr (std::is_convertible_v<decltype(name), std::string_view>)
+                return name;
+            else
+                return std::data(name);  // 例如 `std::array<char, 24>`, 以 NULL 结尾.
+        }
+
         struct ShM_As_Str {
             using is_transparent = int;
 
@@ -1736,10 +3070,3392 @@ struct ShM_Reader {
                 return get_name(a) == get_name(b);
             }
         };
-        std::unordered_set<
-            std::shared_ptr<Shared_Memory<false, writable>>,
-            ShM_As_Str, ShM_As_Str
-        > cache;
+        /* 缓存的条目: 共享内存, 及它自上次检查是否过时以来被命中的次数. */
+        struct Cached {
+            std::shared_ptr<Shared_Memory<false, writable>> shm;
+            mutable std::size_t hits_since_stale_check = 0;
+
+            Cached(decltype(Cached::shm) shm) noexcept: shm{std::move(shm)} {}
+            auto operator->() const noexcept { return this->shm.get(); }
+        };
+        std::unordered_set<Cached, ShM_As_Str, ShM_As_Str> cache;
+        std::size_t stale_check_interval = 0;
+};
+
+
+/**
+ * @brief `ShM_LRU_Cache` 的配置选项.
+ */
+struct ShM_LRU_Cache_Options {
+    std::size_t capacity = 1024;  ///< 最多缓存的条目数.
+    std::size_t max_key_size = 64;
+    std::size_t max_value_size = 1024;
+    std::size_t shards = 16;  ///< 锁的条带数.  越多, worker 之间的竞争越少.
+};
+
+
+/**
+ * @brief 完全位于 shared memory 中的有界 key→blob 缓存, 供同一台机器上的多个 worker
+ *        进程共享 (类似放在共享内存里的 memcached).
+ * @details 由若干个 shard 组成, 每个 shard 有自己的 `Spin_Lock`, 链式哈希索引,
+ *          CLOCK (近似 LRU) 淘汰指针, 以及由定长 slot 组成的 slab (每个 slot 可以
+ *          容纳最长的 key 和 value).  其中只存放偏移量而非指针, 因此各进程可以将它
+ *          映射到不同的地址: 创建者用 `ShM_LRU_Cache::create` 在共享内存分配器上
+ *          构造它, 其它进程用 `ShM_Reader<true>` 按 (名字, 偏移量) 访问.
+ * @note Key 的哈希值由 `stable_hash` 计算, 与编译各进程的标准库无关.
+ * @warning 持有锁的进程崩溃后, 对应的 shard 不再可用.
+ * @note example:
+ * ```
+ * auto allocator = ShM_Resource<std::set>{};
+ * auto& cache = ShM_LRU_Cache::create(allocator, {.capacity = 4, .max_value_size = 16, .shards = 1});
+ * assert( cache.put("a", "1") && cache.put("b", "2") );
+ * assert( cache.get("a") == "1" );
+ * assert( !cache.put("c", std::string(17, 'x')) );  // 超出 `max_value_size`.
+ * for (auto key : {"c", "d", "e"})
+ *     cache.put(key, key);
+ * assert( cache.stats().size == 4 && cache.stats().evictions == 1 );
+ * assert( cache.get("a") && !cache.get("b") );  // "a" 最近被访问过, 因此淘汰了 "b".
+ * // 其它进程:
+ * const auto& arena = allocator.find_arena(&cache);
+ * auto rd = ShM_Reader<true>{};
+ * auto other = rd.template read<ShM_LRU_Cache>(arena.get_name(), (char *)&cache - std::data(arena));
+ * assert( other->get("e") == "e" );
+ * assert( other->erase("e") && !cache.get("e") );
+ * ```
+ */
+class ShM_LRU_Cache {
+        struct Slot {
+            std::uint32_t next;  // 同一个 bucket (或空闲链表) 中下一个 slot 的序号 + 1; 0 表示没有.
+            std::uint32_t key_size, value_size;
+            bool referenced;  // CLOCK 的访问位.
+            std::uint64_t hash;
+            // 紧随其后的是 key 和 value 的字节.
+
+            auto key() const noexcept {
+                return std::string_view{(const char *)(this + 1), this->key_size};
+            }
+            auto value() noexcept {
+                return std::span{(char *)(this + 1) + this->key_size, this->value_size};
+            }
+        };
+        struct alignas(cache_line_size) Shard {
+            Spin_Lock lock;
+            std::uint32_t clock_hand, free_list, size;
+            std::uint64_t hits, misses, evictions;
+            // 紧随其后的是 bucket 数组和 slot 数组.
+        };
+
+        std::uint32_t num_shards, slots_per_shard, buckets_per_shard;
+        std::uint32_t max_key_size, max_value_size, slot_size;
+        std::size_t shard_stride;
+
+        explicit ShM_LRU_Cache(const ShM_LRU_Cache_Options& options) noexcept
+        : num_shards(std::clamp(options.shards, 1uz, std::max(options.capacity, 1uz))),
+          slots_per_shard((std::max(options.capacity, 1uz) + num_shards - 1) / num_shards),
+          buckets_per_shard(slots_per_shard),
+          max_key_size(options.max_key_size), max_value_size(options.max_value_size),
+          slot_size(ceil_to(sizeof(Slot) + options.max_key_size + options.max_value_size, alignof(Slot))),
+          shard_stride(ceil_to_cache_line_size(
+              sizeof(Shard) + ceil_to(buckets_per_shard * sizeof(std::uint32_t), alignof(Slot))
+              + slots_per_shard * slot_size
+          )) {
+            assert(std::max(options.capacity, options.max_key_size + options.max_value_size) <= UINT32_MAX);
+        }
+    public:
+        ShM_LRU_Cache(const ShM_LRU_Cache&) = delete;
+        ShM_LRU_Cache& operator=(const ShM_LRU_Cache&) = delete;
+
+        /**
+         * @brief 按 `options` 构造的缓存所占用的字节数.
+         */
+        static auto size_for(const ShM_LRU_Cache_Options& options) noexcept -> std::size_t {
+            const ShM_LRU_Cache layout{options};  // 只用于计算布局.
+            return ceil_to_cache_line_size(sizeof(ShM_LRU_Cache)) + layout.num_shards * layout.shard_stride;
+        }
+
+        /**
+         * @brief 在 `area` (至少 `size_for(options)` 字节, 按缓存行对齐) 处构造缓存.
+         */
+        static auto create(void *const area, const ShM_LRU_Cache_Options& options) -> ShM_LRU_Cache& {
+            assert(std::uintptr_t(area) % cache_line_size == 0);
+            auto& cache = *new(area) ShM_LRU_Cache{options};
+            for (auto i = 0u; i < cache.num_shards; ++i) {
+                auto& shard = *new(&cache.shard_at(i)) Shard{};
+                std::fill_n(cache.buckets(shard), cache.buckets_per_shard, 0);
+                // 起初所有 slot 都在空闲链表中:
+                for (auto j = 0u; j < cache.slots_per_shard; ++j)
+                    cache.slot(shard, j).next = j + 1 < cache.slots_per_shard ? j + 2 : 0;
+                shard.free_list = 1;
+            }
+            return cache;
+        }
+        /**
+         * @brief 从共享内存分配器中分配并构造缓存.  它不会被自动销毁, 而是随分配器
+         *        释放内存而消失.
+         */
+        static auto create(IPCator auto& allocator, const ShM_LRU_Cache_Options& options) -> ShM_LRU_Cache& {
+            return ShM_LRU_Cache::create(allocator.allocate(size_for(options), cache_line_size), options);
+        }
+
+        /**
+         * @brief 插入或覆盖一个条目.  缓存已满时, 淘汰一个最近未被访问的条目.
+         * @return `key` 或 `value` 超出长度限制时返回 `false`.
+         */
+        bool put(const std::string_view key, const std::string_view value) {
+            if (std::size(key) > this->max_key_size || std::size(value) > this->max_value_size)
+                return false;
+            const auto hash = stable_hash(key);
+            auto& shard = this->shard_of(hash);
+            const std::lock_guard _{shard.lock};
+
+            if (const auto found = this->find_in(shard, hash, key)) {
+                found->value_size = std::size(value);
+                std::ranges::copy(value, std::data(found->value()));
+                found->referenced = true;
+                return true;
+            }
+
+            std::uint32_t index;
+            if (shard.free_list) {
+                index = shard.free_list - 1;
+                shard.free_list = this->slot(shard, index).next;
+                ++shard.size;
+            } else
+                // CLOCK: 跳过 (并清除) 最近被访问过的 slot, 淘汰第一个未被访问过的:
+                for (; true; shard.clock_hand = (shard.clock_hand + 1) % this->slots_per_shard)
+                    if (auto& victim = this->slot(shard, shard.clock_hand); victim.referenced)
+                        victim.referenced = false;
+                    else {
+                        index = shard.clock_hand;
+                        this->unlink(shard, index);
+                        ++shard.evictions;
+                        shard.clock_hand = (shard.clock_hand + 1) % this->slots_per_shard;
+                        break;
+                    }
+
+            auto& slot = this->slot(shard, index);
+            slot.hash = hash;
+            slot.key_size = std::size(key);
+            slot.value_size = std::size(value);
+            slot.referenced = false;
+            std::ranges::copy(key, (char *)(&slot + 1));
+            std::ranges::copy(value, std::data(slot.value()));
+            auto& bucket = this->buckets(shard)[hash / this->num_shards % this->buckets_per_shard];
+            slot.next = std::exchange(bucket, index + 1);
+            return true;
+        }
+        /**
+         * @brief 在持有锁的期间, 以 `std::span<const char>` 的形式将 value 交给 `f`.
+         * @return 是否命中.
+         */
+        bool find(const std::string_view key, const auto& f) {
+            const auto hash = stable_hash(key);
+            auto& shard = this->shard_of(hash);
+            const std::lock_guard _{shard.lock};
+            if (const auto found = this->find_in(shard, hash, key)) {
+                found->referenced = true;
+                ++shard.hits;
+                f(std::span<const char>{found->value()});
+                return true;
+            } else {
+                ++shard.misses;
+                return false;
+            }
+        }
+
+        auto get(const std::string_view key) -> std::optional<std::string> {
+            std::optional<std::string> value;
+            this->find(key, [&](const auto bytes) { value.emplace(std::cbegin(bytes), std::cend(bytes)); });
+            return value;
+        }
+
+        bool erase(const std::string_view key) {
+            const auto hash = stable_hash(key);
+            auto& shard = this->shard_of(hash);
+            const std::lock_guard _{shard.lock};
+            if (const auto found = this->find_in(shard, hash, key)) {
+                const auto index = std::uint32_t(((char *)found - (char *)&this->slot(shard, 0)) / this->slot_size);
+                this->unlink(shard, index);
+                found->next = std::exchange(shard.free_list, index + 1);
+                --shard.size;
+                return true;
+            } else
+                return false;
+        }
+
+        struct Stats {
+            std::size_t size, hits, misses, evictions;
+        };
+        auto stats() -> Stats {
+            Stats stats{};
+            for (auto i = 0u; i < this->num_shards; ++i) {
+                auto& shard = this->shard_at(i);
+                const std::lock_guard _{shard.lock};
+                stats.size += shard.size;
+                stats.hits += shard.hits;
+                stats.misses += shard.misses;
+                stats.evictions += shard.evictions;
+            }
+            return stats;
+        }
+    private:
+        static constexpr auto ceil_to(const std::size_t n, const std::size_t alignment) noexcept -> std::size_t {
+            return (n + alignment - 1) / alignment * alignment;
+        }
+
+        auto shard_at(const std::size_t i) noexcept -> Shard& {
+            return *(Shard *)(
+                (char *)this + ceil_to_cache_line_size(sizeof(ShM_LRU_Cache)) + i * this->shard_stride
+            );
+        }
+        auto shard_of(const std::uint64_t hash) noexcept -> Shard& {
+            return this->shard_at(hash % this->num_shards);
+        }
+        auto buckets(Shard& shard) noexcept -> std::uint32_t * {
+            return (std::uint32_t *)(&shard + 1);
+        }
+        auto slot(Shard& shard, const std::size_t index) noexcept -> Slot& {
+            return *(Slot *)(
+                (char *)(&shard + 1) + ceil_to(this->buckets_per_shard * sizeof(std::uint32_t), alignof(Slot))
+                + index * this->slot_size
+            );
+        }
+
+        auto find_in(Shard& shard, const std::uint64_t hash, const std::string_view key) noexcept -> Slot * {
+            for (
+                auto next = this->buckets(shard)[hash / this->num_shards % this->buckets_per_shard];
+                next; next = this->slot(shard, next - 1).next
+            )
+                if (auto& slot = this->slot(shard, next - 1); slot.hash == hash && slot.key() == key)
+                    return &slot;
+            return nullptr;
+        }
+
+        /* 将 slot 从其所在的 bucket 中移除. */
+        void unlink(Shard& shard, const std::uint32_t index) noexcept {
+            auto& slot = this->slot(shard, index);
+            auto *link = &this->buckets(shard)[slot.hash / this->num_shards % this->buckets_per_shard];
+            while (*link != index + 1)
+                link = &this->slot(shard, *link - 1).next;
+            *link = slot.next;
+        }
+};
+
+
+/**
+ * @brief `ShM_Intern_Table` 的配置选项.
+ */
+struct ShM_Intern_Table_Options {
+    std::size_t capacity = 1 << 16;  ///< 最多容纳的字符串数.
+    std::size_t storage_size = 1 << 20;  ///< 所有字符串的总字节数上限.
+};
+
+
+/**
+ * @brief 位于 shared memory 中的字符串驻留 (intern) 表.
+ * @details 消息中反复出现的字符串 (符号, 标签, 路径等) 只需存储一次, 之后以 32 位
+ *          的 ID 代替.  字符串存放在只追加的存储区中, 由 lock-free 的开放寻址哈希
+ *          索引查找: 写者先追加字符串, 再以 CAS 将它的 ID 发布到索引中, 因此多个
+ *          进程可以同时 `intern` 而无需加锁.  读者用 (只读的) `ShM_Reader` 访问
+ *          该表, `resolve` 得到的 `std::string_view` 直接指向 shared memory.
+ * @note 两个写者同时驻留同一个新字符串时, 二者得到相同的 ID.  落败的一方会撤销
+ *       它占用的 ID 和存储空间, 但若其间已有其它写者占用了之后的 ID (或存储空间),
+ *       就无法撤销而只能浪费掉, 因此 `size()` 可能大于表中不同字符串的数量.
+ * @note example:
+ * ```
+ * auto allocator = ShM_Resource<std::set>{};
+ * auto& table = ShM_Intern_Table::create(allocator, {.capacity = 100, .storage_size = 4096});
+ * const auto id = *table.intern("/usr/lib/libc.so.6");
+ * assert( table.intern("/usr/lib/libc.so.6") == id );
+ * assert( table.intern("AAPL") != id );
+ * assert( table.find("AAPL") && !table.find("MSFT") );
+ * assert( std::size(table) == 2 );
+ * const auto too_long = table.intern(std::string(5000, 'x'));  // 超出存储空间.
+ * assert( !too_long && std::size(table) == 2 );  // 失败的驻留不消耗 ID.
+ * // 其它进程:
+ * const auto& arena = allocator.find_arena(&table);
+ * auto rd = ShM_Reader{};
+ * auto other = rd.template read<ShM_Intern_Table>(arena.get_name(), (char *)&table - std::data(arena));
+ * assert( other->resolve(id) == "/usr/lib/libc.so.6" );
+ * ```
+ */
+class ShM_Intern_Table {
+        struct Entry {
+            std::uint64_t hash, offset;
+            std::uint32_t size;
+        };
+
+        std::uint32_t capacity, num_buckets;
+        std::size_t storage_size;
+        std::atomic<std::uint32_t> next_id{};
+        std::atomic<std::size_t> storage_used{};
+        static_assert(decltype(next_id)::is_always_lock_free && decltype(storage_used)::is_always_lock_free);
+
+        explicit ShM_Intern_Table(const ShM_Intern_Table_Options& options) noexcept
+        : capacity(options.capacity),
+          num_buckets(std::bit_ceil(2 * options.capacity)),  // 负载因子不超过 1/2.
+          storage_size(options.storage_size) {
+            assert(0 < options.capacity && options.capacity <= 1uz << 30);  // 桶数不能超出 32 位.
+        }
+    public:
+        using id_type = std::uint32_t;
+
+        ShM_Intern_Table(const ShM_Intern_Table&) = delete;
+        ShM_Intern_Table& operator=(const ShM_Intern_Table&) = delete;
+
+        /**
+         * @brief 按 `options` 构造的表所占用的字节数.
+         */
+        static auto size_for(const ShM_Intern_Table_Options& options) noexcept -> std::size_t {
+            const ShM_Intern_Table layout{options};  // 只用于计算布局.
+            return layout.storage_offset() + layout.storage_size;
+        }
+
+        /**
+         * @brief 在 `area` (至少 `size_for(options)` 字节) 处构造表.
+         */
+        static auto create(void *const area, const ShM_Intern_Table_Options& options) -> ShM_Intern_Table& {
+            assert(std::uintptr_t(area) % alignof(ShM_Intern_Table) == 0);
+            auto& table = *new(area) ShM_Intern_Table{options};
+            std::uninitialized_value_construct_n(table.buckets(), table.num_buckets);
+            return table;
+        }
+        /**
+         * @brief 从共享内存分配器中分配并构造表.
+         */
+        static auto create(IPCator auto& allocator, const ShM_Intern_Table_Options& options) -> ShM_Intern_Table& {
+            return ShM_Intern_Table::create(allocator.allocate(size_for(options), cache_line_size), options);
+        }
+
+        /**
+         * @brief 返回 `str` 的 ID; 尚未驻留时先将其加入表中.
+         * @return 表中的 ID 或存储空间已用尽时, 返回 `std::nullopt`.
+         */
+        auto intern(const std::string_view str) noexcept -> std::optional<id_type> {
+            const auto hash = stable_hash(str);
+            auto reserved = std::optional<id_type>{};  // 在遇到空位时才分配 ID 和存储空间.
+            for (auto i = hash; true; ++i) {
+                auto& bucket = this->buckets()[i & (this->num_buckets - 1)];
+                auto published = bucket.load(std::memory_order_acquire);
+                if (!published) {
+                    if (!reserved && !(reserved = this->append(str, hash)))
+                        return std::nullopt;
+                    if (bucket.compare_exchange_strong(
+                        published, *reserved + 1,
+                        std::memory_order_release, std::memory_order_acquire
+                    ))
+                        return reserved;
+                    // 被其它写者抢先了, 检查它发布的是不是同一个字符串.
+                }
+                if (this->matches(published - 1, str, hash)) {
+                    if (reserved)
+                        this->retract(*reserved);
+                    return published - 1;
+                }
+            }
+        }
+
+        /**
+         * @brief 查找 `str` 的 ID, 但不会将其加入表中.
+         */
+        auto find(const std::string_view str) const noexcept -> std::optional<id_type> {
+            const auto hash = stable_hash(str);
+            for (auto i = hash; true; ++i)
+                if (const auto published = this->buckets()[i & (this->num_buckets - 1)].load(std::memory_order_acquire); !published)
+                    return std::nullopt;
+                else if (this->matches(published - 1, str, hash))
+                    return published - 1;
+        }
+
+        /**
+         * @brief 由 ID 得到字符串, 它指向 shared memory.
+         * @warning `id` 必须是 `intern` 返回过的.
+         */
+        auto resolve(const id_type id) const noexcept -> std::string_view {
+            assert(id < this->size());
+            const auto& entry = this->entries()[id];
+            return {(const char *)this + this->storage_offset() + entry.offset, entry.size};
+        }
+
+        /**
+         * @brief 已分配的 ID 的数量.  ID 从 0 开始连续分配.
+         * @note 可能包含并发驻留时被浪费的 ID, 见类的说明.
+         */
+        auto size() const noexcept -> std::size_t {
+            return this->next_id.load(std::memory_order_acquire);
+        }
+    private:
+        auto buckets() const noexcept -> std::atomic<id_type> * {
+            return (std::atomic<id_type> *)(
+                (char *)this + ceil_to_cache_line_size(sizeof(ShM_Intern_Table))
+            );
+        }
+        auto entries() const noexcept -> Entry * {
+            return (Entry *)(this->buckets() + ceil_to_cache_line_size(this->num_buckets * sizeof(id_type)) / sizeof(id_type));
+        }
+        auto storage_offset() const noexcept -> std::size_t {
+            return ceil_to_cache_line_size(sizeof(ShM_Intern_Table))
+                   + ceil_to_cache_line_size(this->num_buckets * sizeof(id_type))
+                   + ceil_to_cache_line_size(this->capacity * sizeof(Entry));
+        }
+
+        /* 分配 ID 和存储空间, 并写入字符串; 此时它尚未被发布. */
+        auto append(const std::string_view str, const std::uint64_t hash) noexcept -> std::optional<id_type> {
+            // 先检查再占用, 使失败的 `intern` 不消耗任何 ID 或存储空间:
+            auto offset = this->storage_used.load(std::memory_order_relaxed);
+            do
+                if (std::size(str) > this->storage_size - offset)
+                    return std::nullopt;
+            while (!this->storage_used.compare_exchange_weak(offset, offset + std::size(str), std::memory_order_relaxed));
+            // 存储空间在 ID 用尽时才会被浪费, 而那时已不可能再驻留新的字符串了:
+            auto id = this->next_id.load(std::memory_order_relaxed);
+            do
+                if (id >= this->capacity)
+                    return std::nullopt;
+            while (!this->next_id.compare_exchange_weak(id, id + 1, std::memory_order_relaxed));
+            std::ranges::copy(str, (char *)this + this->storage_offset() + offset);
+            this->entries()[id] = {hash, offset, id_type(std::size(str))};
+            return id;
+        }
+
+        /* 撤销 `append` 的占用.  只有当它们仍是最后被占用的 ID 或存储空间时才能撤销. */
+        void retract(const id_type id) noexcept {
+            const auto [_, offset, size] = this->entries()[id];
+            auto storage_end = offset + size;
+            this->storage_used.compare_exchange_strong(storage_end, offset, std::memory_order_relaxed);
+            auto next_id = id + 1;
+            this->next_id.compare_exchange_strong(next_id, id, std::memory_order_relaxed);
+        }
+
+        auto matches(const id_type id, const std::string_view str, const std::uint64_t hash) const noexcept -> bool {
+            return this->entries()[id].hash == hash && this->resolve(id) == str;
+        }
+};
+
+
+/**
+ * @brief 位于 shared memory 中的 generational slot map: 以稳定的 64 位 handle
+ *        (序号 + 代数) 代替 (名字, 偏移量) 引用其中的对象.
+ * @details 每个 slot 都有一个代数, 对象被删除时代数递增, 因此任何进程都能以 O(1)
+ *          的代价解析 handle, 并在不访问已释放内存的前提下识别出过期的 handle.
+ *          Slot 的存储是定长的, 从共享内存分配器 (例如 `ShM_Pool`) 中一次性分配,
+ *          对象就地存放在 slot 中.  `insert`/`erase` 由一个 `Spin_Lock` 串行化;
+ *          `load` 则不加锁, 以类似 seqlock 的方式在拷贝前后各检查一次代数.
+ * @tparam T 存放的对象的类型.  它不能含有指针等进程私有的状态.
+ * @note example:
+ * ```
+ * auto pool = ShM_Pool<false>{};
+ * auto& map = ShM_Slot_Map<std::array<int, 4>>::create(pool, 2);
+ * const auto a = *map.insert(std::array{1, 2, 3, 4});
+ * const auto b = *map.insert();
+ * const auto full = map.insert();
+ * assert( !full );  // 已满.
+ * assert( map.get(a)->at(2) == 3 );
+ * const auto erased = map.erase(b), erased_again = map.erase(b);
+ * assert( erased && !map.get(b) && !erased_again );
+ * const auto c = *map.insert();  // 复用 `b` 的 slot, 但代数不同.
+ * assert( c.index == b.index && c != b && !map.load(b) );
+ * // 其它进程:
+ * const auto& arena = pool.upstream_resource()->find_arena(&map);
+ * auto rd = ShM_Reader{};
+ * auto other = rd.template read<ShM_Slot_Map<std::array<int, 4>>>(arena.get_name(), (char *)&map - std::data(arena));
+ * assert( other->load(a)->at(3) == 4 );
+ * ```
+ */
+template <class T>
+class ShM_Slot_Map {
+    public:
+        /**
+         * @brief 可以放入队列等处传递的 handle.  默认构造的 handle 不指向任何对象.
+         */
+        struct Handle {
+            std::uint32_t index, generation;  // 代数为奇数表示 slot 正在被占用.
+            bool operator==(const Handle&) const = default;
+        };
+        static_assert(sizeof(Handle) == 8);
+    private:
+        struct Slot {
+            std::atomic<std::uint32_t> generation;
+            std::uint32_t next_free;  // 空闲链表中下一个 slot 的序号 + 1; 0 表示没有.
+            alignas(T) std::byte storage[sizeof(T)];
+        };
+
+        Spin_Lock lock;
+        std::uint32_t capacity_, free_list;
+        std::atomic<std::uint32_t> size_{};
+
+        explicit ShM_Slot_Map(const std::size_t capacity) noexcept
+        : capacity_(capacity), free_list(capacity ? 1 : 0) {
+            assert(capacity <= UINT32_MAX);
+        }
+    public:
+        ShM_Slot_Map(const ShM_Slot_Map&) = delete;
+        ShM_Slot_Map& operator=(const ShM_Slot_Map&) = delete;
+
+        static auto size_for(const std::size_t capacity) noexcept -> std::size_t {
+            return slots_offset() + capacity * sizeof(Slot);
+        }
+
+        /**
+         * @brief 在 `area` (至少 `size_for(capacity)` 字节) 处构造有 `capacity` 个 slot 的表.
+         */
+        static auto create(void *const area, const std::size_t capacity) -> ShM_Slot_Map& {
+            assert(std::uintptr_t(area) % alignof(Slot) == 0);
+            auto& map = *new(area) ShM_Slot_Map{capacity};
+            for (auto i = 0u; auto& slot : map.slots()) {
+                ++i;
+                new(&slot.generation) std::atomic<std::uint32_t>{};
+                slot.next_free = i < capacity ? i + 1 : 0;
+            }
+            return map;
+        }
+        /**
+         * @brief 从共享内存分配器中分配并构造表.
+         */
+        static auto create(IPCator auto& allocator, const std::size_t capacity) -> ShM_Slot_Map& {
+            return ShM_Slot_Map::create(
+                allocator.allocate(size_for(capacity), std::max(alignof(Slot), cache_line_size)), capacity
+            );
+        }
+
+        /**
+         * @brief 就地构造一个对象.
+         * @return 它的 handle; 所有 slot 都被占用时返回 `std::nullopt`.
+         */
+        template <class... Args>
+        auto insert(Args&&... args) -> std::optional<Handle> {
+            const std::lock_guard _{this->lock};
+            if (!this->free_list)
+                return std::nullopt;
+            const auto index = this->free_list - 1;
+            auto& slot = this->slots()[index];
+            new(slot.storage) T(std::forward<Args>(args)...);
+            this->free_list = slot.next_free;
+            const auto generation = slot.generation.load(std::memory_order_relaxed) + 1;
+            slot.generation.store(generation, std::memory_order_release);
+            this->size_.fetch_add(1, std::memory_order_relaxed);
+            return Handle{index, generation};
+        }
+
+        /**
+         * @brief 删除 handle 所指的对象, 使所有指向它的 handle 过期.
+         * @return handle 已过期时返回 `false`.
+         */
+        bool erase(const Handle handle) {
+            const std::lock_guard _{this->lock};
+            if (!this->contains(handle))
+                return false;
+            auto& slot = this->slots()[handle.index];
+            slot.generation.store(handle.generation + 1, std::memory_order_release);
+            // 之后对 slot 的写入 (析构, 以及下次 `insert` 的构造) 不得被重排到上面的 store
+            // 之前, 否则 `load` 可能拷贝到新对象的字节, 却仍看到旧的代数:
+            std::atomic_thread_fence(std::memory_order_release);
+            std::destroy_at((T *)slot.storage);
+            slot.next_free = std::exchange(this->free_list, handle.index + 1);
+            this->size_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        bool contains(const Handle handle) const noexcept {
+            return handle.index < this->capacity_
+                   && handle.generation & 1
+                   && this->slots()[handle.index].generation.load(std::memory_order_acquire) == handle.generation;
+        }
+
+        /**
+         * @brief 解析 handle.  过期时返回 `nullptr`.
+         * @warning 返回的指针在对象被 (其它进程) 删除之后就会失效; 若删除可能与
+         *          访问并发, 使用 `load`.
+         */
+        auto get(const Handle handle) noexcept -> T * {
+            return this->contains(handle) ? (T *)this->slots()[handle.index].storage : nullptr;
+        }
+        auto get(const Handle handle) const noexcept -> const T * {
+            return this->contains(handle) ? (const T *)this->slots()[handle.index].storage : nullptr;
+        }
+
+        /**
+         * @brief 拷贝 handle 所指的对象.  即使对象在拷贝期间被删除, 也能正确地返回
+         *        `std::nullopt`, 而不会返回新旧混杂的数据.
+         */
+        auto load(const Handle handle) const noexcept -> std::optional<T>
+        requires std::is_trivially_copyable_v<T> {
+            if (!this->contains(handle))
+                return std::nullopt;
+            // 拷贝到未初始化的存储中, 不要求 `T` 可默认构造:
+            alignas(T) std::byte copy[sizeof(T)];
+            std::memcpy(copy, this->slots()[handle.index].storage, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (this->slots()[handle.index].generation.load(std::memory_order_relaxed) != handle.generation)
+                return std::nullopt;
+            return *std::launder((const T *)copy);
+        }
+
+        auto size() const noexcept -> std::size_t { return this->size_.load(std::memory_order_relaxed); }
+        auto capacity() const noexcept -> std::size_t { return this->capacity_; }
+    private:
+        static constexpr auto slots_offset() noexcept {
+            return (sizeof(ShM_Slot_Map) + alignof(Slot) - 1) / alignof(Slot) * alignof(Slot);
+        }
+        auto slots() const noexcept {
+            return std::span{(Slot *)((char *)this + slots_offset()), this->capacity_};
+        }
+};
+
+
+/**
+ * @brief 基于 handle 的, 可以压缩 (整理碎片) 的共享内存堆.
+ * @details 长期运行时, `ShM_Pool` 的 arena 会产生碎片, 而裸指针使得对象无法被移动.
+ *          这里, 对象只能通过 `ShM_Slot_Map` 式的 handle 引用: handle 先经由位于
+ *          shared memory 中的间接表 (`Table`) 解析出对象所在的 `Shared_Memory` 的
+ *          名字和偏移量.  于是 `compact` 可以将存活的对象搬到一块新的 `Shared_Memory`
+ *          中, 更新间接表, 并回收旧的 segment, 使内存占用在数周的运行中保持平稳.
+ *
+ *          间接表带有一个全局的 epoch, 压缩期间为奇数.  读者解析 handle 时在前后
+ *          各检查一次 epoch (类似 seqlock); 缓存了解析结果的读者只需比较 epoch
+ *          就知道是否需要重新解析.
+ * @note 该类的实例 (所有者) 不是线程安全的, 且只有所有者会移动对象.  旧的 segment
+ *       在下一次 `compact` 时才被删除, 以免正在解析 handle 的读者扑空.  读者应
+ *       定期调用 `ShM_Reader::gc_`, 以释放对旧 segment 的映射.
+ * @note example:
+ * ```
+ * auto heap = ShM_Compacting_Heap{100, 4096};
+ * std::vector<ShM_Compacting_Heap::Handle> handles;
+ * for (auto i : std::views::iota(0, 20)) {
+ *     handles.push_back(heap.allocate(1000));
+ *     *heap.template get<int>(handles.back()) = i;
+ * }
+ * assert( heap.num_segments() == 5 );
+ * for (auto i = 0; i < 20; i += 2)
+ *     heap.deallocate(handles[i]);
+ * assert( heap.num_segments() == 5 && heap.live_bytes() == 10 * 1000 );
+ * // 其它进程:
+ * auto rd = ShM_Reader{};
+ * auto table = rd.template read<ShM_Compacting_Heap::Table>(heap.get_table_name(), 0);
+ * const auto epoch = table->epoch();
+ * heap.compact();
+ * assert( heap.num_segments() == 1 && table->epoch() != epoch );
+ * assert( **table->template read<int>(rd, handles[3]) == 3 );
+ * assert( !table->template read<int>(rd, handles[2]) );
+ * ```
+ */
+class ShM_Compacting_Heap {
+    public:
+        /**
+         * @brief 对象的位置.  `segment` 是以 NULL 结尾的名字, 见 `generate_shm_UUName`.
+         */
+        struct Location {
+            std::array<char, 24> segment;
+            std::size_t offset, size, alignment;
+        };
+        using Handle = ShM_Slot_Map<Location>::Handle;
+
+        /**
+         * @brief 位于 shared memory 中的间接表.  读者以 `ShM_Reader` 在偏移量 0 处读取它.
+         */
+        class Table {
+                friend ShM_Compacting_Heap;
+                std::atomic<std::uint64_t> epoch_{};
+                Table() = default;
+
+                auto map() noexcept -> ShM_Slot_Map<Location>& {
+                    return *(ShM_Slot_Map<Location> *)((char *)this + cache_line_size);
+                }
+                auto map() const noexcept -> const ShM_Slot_Map<Location>& {
+                    return *(const ShM_Slot_Map<Location> *)((const char *)this + cache_line_size);
+                }
+            public:
+                Table(const Table&) = delete;
+                Table& operator=(const Table&) = delete;
+
+                auto epoch() const noexcept {
+                    return this->epoch_.load(std::memory_order_acquire);
+                }
+
+                /**
+                 * @brief 解析 handle.  压缩正在进行时等待它结束.
+                 * @return handle 已过期时返回 `std::nullopt`.
+                 */
+                auto locate(const Handle handle) const noexcept -> std::optional<Location> {
+                    while (true) {
+                        const auto before = this->epoch();
+                        if (before & 1) {
+                            std::this_thread::yield();
+                            continue;
+                        }
+                        const auto location = this->map().load(handle);
+                        std::atomic_thread_fence(std::memory_order_acquire);
+                        if (this->epoch_.load(std::memory_order_relaxed) == before)
+                            return location;
+                    }
+                }
+
+                /**
+                 * @brief 解析 handle, 并通过 `reader` 访问对象.
+                 * @return handle 已过期时返回 `std::nullopt`.
+                 */
+                template <class T, auto writable>
+                auto read(ShM_Reader<writable>& reader, const Handle handle) const
+                -> std::optional<decltype(reader.template read<T>({}, 0))> {
+                    // 回收的 segment 都已不被间接表引用, 所以它们不存在时, 重新解析即可.
+                    // 若两次解析到同一个不存在的 segment, 则它不是被回收的, 照常报错.
+                    for (auto missing = std::optional<std::array<char, 24>>{}; true; ) {
+                        const auto location = this->locate(handle);
+                        if (!location)
+                            return std::nullopt;
+                        const auto name = std::data(location->segment);
+                        const auto missing_again = missing == location->segment;
+                        // `ShM_Reader` 打开不存在的名字时会等待至多 1s, 因此先确认一下:
+                        if (!missing_again && !reader.contains(name)) {
+                            const auto fd = POSIX::shm_open(name, O_RDONLY, 0);
+                            if (fd == -1) {
+                                missing = location->segment;
+                                continue;
+                            }
+                            ::close(fd);
+                        }
+                        try {
+                            return reader.template read<T>(name, location->offset);
+                        } catch (const std::filesystem::filesystem_error&) {
+                            if (missing_again)
+                                throw;
+                            missing = location->segment;  // 在确认之后才被回收了.
+                        }
+                    }
+                }
+        };
+    private:
+        struct Extent {
+            Shared_Memory<true> shm;
+            std::size_t used = 0, live = 0;
+        };
+        Shared_Memory<true> table_shm;
+        std::size_t segment_size;
+        std::vector<Extent> extents, retired;
+        std::vector<std::pair<Handle, char *>> addresses;  // 按 handle 的序号索引.
+
+        auto& table() noexcept { return *(Table *)std::data(this->table_shm); }
+    public:
+        /**
+         * @param capacity 最多同时存活的对象数.
+         * @param segment_size 新建的 segment 的最小长度.
+         */
+        explicit ShM_Compacting_Heap(const std::size_t capacity, const std::size_t segment_size = 1uz << 20)
+        : table_shm{
+              generate_shm_UUName(),
+              ceil_to_page_size(cache_line_size + ShM_Slot_Map<Location>::size_for(capacity))
+          },
+          segment_size{segment_size}, addresses(capacity) {
+            new(std::data(this->table_shm)) Table;
+            ShM_Slot_Map<Location>::create(std::data(this->table_shm) + cache_line_size, capacity);
+        }
+        ShM_Compacting_Heap(ShM_Compacting_Heap&&) = default;
+        ShM_Compacting_Heap& operator=(ShM_Compacting_Heap&&) = default;
+
+        /**
+         * @brief 读者据此找到间接表.
+         */
+        auto& get_table_name() const noexcept { return this->table_shm.get_name(); }
+
+        /**
+         * @exception 存活的对象数达到上限时抛出 `std::bad_alloc`.
+         */
+        auto allocate(const std::size_t size, const std::size_t alignment = alignof(std::max_align_t)) -> Handle {
+            assert(size && std::has_single_bit(alignment) && alignment <= ::getpagesize() + 0uz);
+            if (this->table().map().size() == this->table().map().capacity())
+                throw std::bad_alloc{};
+            auto [location, address] = this->place(this->extents, size, alignment);
+            const auto handle = *this->table().map().insert(location);
+            this->addresses[handle.index] = {handle, address};
+            return handle;
+        }
+
+        void deallocate(const Handle handle) {
+            const auto location = this->table().map().get(handle);
+            assert(location);
+            const auto extent = std::ranges::find(
+                this->extents, std::string_view{std::data(location->segment)}, [](auto& extent) -> auto& { return extent.shm.get_name(); }
+            );
+            extent->live -= location->size;
+            this->table().map().erase(handle);
+            this->addresses[handle.index] = {};
+            // 不再有存活对象的 segment (正在填充的除外) 待下次压缩时删除:
+            if (!extent->live && std::next(extent) != std::end(this->extents)) {
+                this->retired.push_back(std::move(*extent));
+                this->extents.erase(extent);
+            }
+        }
+
+        /**
+         * @brief 所有者访问对象.  handle 过期时返回 `nullptr`.
+         * @warning 返回的指针在 `compact` 之后失效.
+         */
+        template <class T>
+        auto get(const Handle handle) const noexcept -> T * {
+            const auto& [current, address] = this->addresses[handle.index];
+            return current == handle ? (T *)address : nullptr;
+        }
+
+        /**
+         * @brief 将所有存活的对象紧凑地搬到一块新的 `Shared_Memory` 中.
+         * @details 上一次压缩 (或释放) 留下的 segment 在此时被删除.
+         */
+        void compact() {
+            this->retired.clear();
+
+            auto needed = 0uz;
+            for (const auto& [handle, address] : this->addresses)
+                if (address)
+                    needed += this->table().map().get(handle)->size + this->table().map().get(handle)->alignment - 1;
+            std::vector<Extent> compacted;
+            compacted.push_back({Shared_Memory{generate_shm_UUName(), ceil_to_page_size(std::max(needed, this->segment_size))}});
+
+            auto& epoch = this->table().epoch_;
+            epoch.fetch_add(1, std::memory_order_relaxed);  // 奇数: 压缩正在进行.
+            std::atomic_thread_fence(std::memory_order_release);
+            for (auto& [handle, address] : this->addresses)
+                if (address) {
+                    auto& location = *this->table().map().get(handle);
+                    auto [moved, new_address] = this->place(compacted, location.size, location.alignment);
+                    std::memcpy(new_address, address, location.size);
+                    location = moved;
+                    address = new_address;
+                }
+            epoch.fetch_add(1, std::memory_order_release);
+
+            this->retired = std::exchange(this->extents, std::move(compacted));
+        }
+
+        auto num_segments() const noexcept { return std::size(this->extents); }
+        /**
+         * @brief 所有 (未退役的) segment 的总长度.
+         */
+        auto mapped_bytes() const noexcept {
+            auto bytes = 0uz;
+            for (const auto& extent : this->extents)
+                bytes += std::size(extent.shm);
+            return bytes;
+        }
+        auto live_bytes() const noexcept {
+            auto bytes = 0uz;
+            for (const auto& extent : this->extents)
+                bytes += extent.live;
+            return bytes;
+        }
+    private:
+        /* 在最后一个 extent 中按 bump 的方式分配; 放不下时新建一个. */
+        auto place(std::vector<Extent>& extents, const std::size_t size, const std::size_t alignment)
+        -> std::pair<Location, char *> {
+            const auto fits = [&](const Extent& extent) {
+                return (extent.used + alignment - 1) / alignment * alignment + size <= std::size(extent.shm);
+            };
+            if (std::empty(extents) || !fits(extents.back()))
+                extents.push_back({Shared_Memory{generate_shm_UUName(), ceil_to_page_size(std::max(size, this->segment_size))}});
+            auto& extent = extents.back();
+            const auto offset = (extent.used + alignment - 1) / alignment * alignment;
+            extent.used = offset + size;
+            extent.live += size;
+
+            Location location{{}, offset, size, alignment};
+            assert(std::size(extent.shm.get_name()) < std::size(location.segment));
+            std::ranges::copy(extent.shm.get_name(), std::data(location.segment));
+            return {location, std::data(extent.shm) + offset};
+        }
+};
+
+
+/**
+ * @brief 位于 shared memory 中的 B+tree, 用于有序的点查询和范围查询 (例如订单簿,
+ *        按时间索引的事件).
+ * @details 节点的大小是 256 bytes (若干个缓存行), 从共享内存分配器分配的一整块
+ *          内存中按序号分配, 节点之间以序号而非指针相连.  节点内的键以 AVX2 (CPU
+ *          不支持时退化为标量循环) 并行比较.
+ *
+ *          只允许一个写者; 其它进程中的读者以 `ShM_Reader` 访问, 采用 optimistic
+ *          lock coupling: 每个节点有一个版本号, 写者修改节点期间它为奇数.  读者
+ *          不加锁, 读完一个节点后校验其版本号未变, 否则从根重新开始.
+ * @tparam Value 可平凡拷贝的值类型.
+ * @note `erase` 不会合并节点, 节点也不会被回收 (之后插入同一范围的键时会复用).
+ * @note example:
+ * ```
+ * auto allocator = ShM_Resource<std::set>{};
+ * auto& tree = ShM_BTree<double>::create(allocator, 1000);
+ * for (auto key : std::views::iota(0, 1000))
+ *     tree.insert(key * 10, key * .5);
+ * assert( std::size(tree) == 1000 );
+ * assert( tree.find(420) == 21. && !tree.find(421) );
+ * assert( tree.erase(420) && !tree.find(420) );
+ * // 其它进程:
+ * const auto& arena = allocator.find_arena(&tree);
+ * auto rd = ShM_Reader{};
+ * auto other = rd.template read<ShM_BTree<double>>(arena.get_name(), (char *)&tree - std::data(arena));
+ * auto sum = 0.;
+ * other->scan(100, 150, [&](auto, auto value) { sum += value; });
+ * assert( sum == 5 + 5.5 + 6 + 6.5 + 7 + 7.5 );
+ * ```
+ */
+template <class Value>
+class ShM_BTree {
+        static_assert(std::is_trivially_copyable_v<Value>);
+    public:
+        using key_type = std::int64_t;
+    private:
+        static constexpr std::size_t node_size = 256, keys_offset = 32;
+
+        struct Node {
+            std::atomic<std::uint64_t> version;  // 奇数: 写者正在修改.
+            std::uint32_t count;
+            std::uint32_t next;  // 仅用于 leaf: 右侧的 leaf 的序号 + 1; 0 表示没有.
+            bool leaf;
+        };
+        struct alignas(cache_line_size) Leaf: Node {
+            static constexpr auto capacity = (node_size - keys_offset) / (sizeof(key_type) + sizeof(Value));
+            alignas(32) key_type keys[capacity];
+            Value values[capacity];
+        };
+        struct alignas(cache_line_size) Inner: Node {
+            static constexpr auto capacity = (node_size - keys_offset - sizeof(std::uint32_t))
+                                             / (sizeof(key_type) + sizeof(std::uint32_t));
+            alignas(32) key_type keys[capacity];
+            std::uint32_t children[capacity + 1];  // `children[i]` 中的键位于 [`keys[i-1]`, `keys[i]`).
+        };
+        static_assert(Leaf::capacity >= 2 && sizeof(Leaf) <= node_size && sizeof(Inner) <= node_size);
+        // 以 4 个键为一组比较时, 最后一组可能越过键数组, 但不会越过节点:
+        static_assert(keys_offset + (Leaf::capacity + 3) / 4 * 4 * sizeof(key_type) <= node_size);
+        static_assert(keys_offset + (Inner::capacity + 3) / 4 * 4 * sizeof(key_type) <= node_size);
+
+        std::atomic<std::uint64_t> version{};  // 保护 `root`.
+        std::atomic<std::uint32_t> root{};
+        std::uint32_t max_nodes;
+        std::atomic<std::uint32_t> num_nodes{};
+        std::atomic<std::size_t> size_{};
+
+        explicit ShM_BTree(const std::size_t max_nodes) noexcept: max_nodes(max_nodes) {
+            assert(0 < max_nodes && max_nodes <= UINT32_MAX);
+        }
+    public:
+        ShM_BTree(const ShM_BTree&) = delete;
+        ShM_BTree& operator=(const ShM_BTree&) = delete;
+
+        static auto size_for(const std::size_t max_nodes) noexcept -> std::size_t {
+            return node_size * (1 + max_nodes);
+        }
+
+        /**
+         * @brief 在 `area` (至少 `size_for(max_nodes)` 字节, 按缓存行对齐) 处构造空树.
+         */
+        static auto create(void *const area, const std::size_t max_nodes) -> ShM_BTree& {
+            assert(std::uintptr_t(area) % cache_line_size == 0);
+            static_assert(sizeof(ShM_BTree) <= node_size);
+            auto& tree = *new(area) ShM_BTree{max_nodes};
+            tree.root.store(tree.template new_node<Leaf>(), std::memory_order_relaxed);
+            return tree;
+        }
+        /**
+         * @brief 从共享内存分配器中分配并构造空树.
+         */
+        static auto create(IPCator auto& allocator, const std::size_t max_nodes) -> ShM_BTree& {
+            return ShM_BTree::create(allocator.allocate(size_for(max_nodes), cache_line_size), max_nodes);
+        }
+
+        /**
+         * @brief 插入, 或覆盖已有的值.  只能由唯一的写者调用.
+         * @exception 节点用尽时抛出 `std::bad_alloc`, 树保持不变.
+         */
+        void insert(const key_type key, const Value& value) {
+            std::uint32_t path[64], slots[64];  // 从根到 leaf 经过的 inner 节点, 以及在其中选择的 child.
+            auto depth = 0uz;
+            auto index = this->root.load(std::memory_order_relaxed);
+            for (; !this->node(index).leaf; ++depth) {
+                auto& inner = this->template node<Inner>(index);
+                path[depth] = index;
+                slots[depth] = rank(inner.keys, inner.count, key, true);
+                index = inner.children[slots[depth]];
+            }
+            auto& leaf = this->template node<Leaf>(index);
+            const auto pos = rank(leaf.keys, leaf.count, key, false);
+
+            if (pos < leaf.count && leaf.keys[pos] == key) {
+                lock(leaf);
+                leaf.values[pos] = value;
+                unlock(leaf);
+                return;
+            }
+            if (leaf.count == Leaf::capacity && this->num_nodes.load(std::memory_order_relaxed) + depth + 2 > this->max_nodes)
+                throw std::bad_alloc{};
+
+            // 修改的节点全部保持锁定, 直到分裂一路传播完毕, 以免读者看到中间状态:
+            Node *locked[64 + 2];
+            auto num_locked = 0uz;
+            locked[num_locked++] = &leaf;
+            lock(leaf);
+            auto separator = key_type{};
+            auto new_child = this->split_insert(leaf, pos, key, value, separator);
+            for (; new_child && depth; --depth) {
+                auto& parent = this->template node<Inner>(path[depth - 1]);
+                locked[num_locked++] = &parent;
+                lock(parent);
+                new_child = this->split_insert(parent, slots[depth - 1], separator, new_child, separator);
+            }
+            if (new_child) {  // 根分裂了.
+                const auto new_root = this->template new_node<Inner>();
+                auto& root = this->template node<Inner>(new_root);
+                root.count = 1;
+                root.keys[0] = separator;
+                root.children[0] = this->root.load(std::memory_order_relaxed);
+                root.children[1] = new_child;
+                lock(this->version);
+                this->root.store(new_root, std::memory_order_relaxed);
+                unlock(this->version);
+            }
+            while (num_locked)
+                unlock(*locked[--num_locked]);
+            this->size_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief 只能由唯一的写者调用.
+         */
+        bool erase(const key_type key) {
+            auto index = this->root.load(std::memory_order_relaxed);
+            while (!this->node(index).leaf) {
+                auto& inner = this->template node<Inner>(index);
+                index = inner.children[rank(inner.keys, inner.count, key, true)];
+            }
+            auto& leaf = this->template node<Leaf>(index);
+            const auto pos = rank(leaf.keys, leaf.count, key, false);
+            if (pos == leaf.count || leaf.keys[pos] != key)
+                return false;
+            lock(leaf);
+            std::copy(leaf.keys + pos + 1, leaf.keys + leaf.count, leaf.keys + pos);
+            std::copy(leaf.values + pos + 1, leaf.values + leaf.count, leaf.values + pos);
+            --leaf.count;
+            unlock(leaf);
+            this->size_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        auto find(const key_type key) const noexcept -> std::optional<Value> {
+            while (true) {
+                const auto [index, version] = this->find_leaf(key);
+                const auto& leaf = this->template node<Leaf>(index);
+                const auto count = std::min<std::size_t>(leaf.count, Leaf::capacity);
+                const auto pos = rank(leaf.keys, count, key, false);
+                auto value = pos < count && leaf.keys[pos] == key
+                             ? std::optional<Value>{leaf.values[pos]} : std::nullopt;
+                if (validate(leaf, version))
+                    return value;
+            }
+        }
+
+        /**
+         * @brief 按键的升序, 对 [`lo`, `hi`] 中的每个条目调用 `f(key, value)`.
+         * @details 逐个 leaf 拷贝并校验, 因此 `f` 看到的每个 leaf 都是一致的; 但与
+         *          写者并发时, 整个范围并不是同一时刻的快照.
+         */
+        void scan(key_type lo, const key_type hi, const auto& f) const {
+            while (lo <= hi) {
+                auto [index, version] = this->find_leaf(lo);
+                while (true) {
+                    const auto& leaf = this->template node<Leaf>(index);
+                    const auto count = std::min<std::size_t>(leaf.count, Leaf::capacity);
+                    key_type keys[(Leaf::capacity + 3) / 4 * 4];
+                    Value values[Leaf::capacity];
+                    std::copy_n(leaf.keys, count, keys);
+                    std::copy_n(leaf.values, count, values);
+                    const auto next = leaf.next;
+                    if (!validate(leaf, version))
+                        break;  // 从 `lo` 处重新开始.
+
+                    for (auto i = rank(keys, count, lo, false); i < count; ++i)
+                        if (keys[i] > hi)
+                            return;
+                        else {
+                            f(keys[i], std::as_const(values[i]));
+                            if (keys[i] == hi)
+                                return;
+                            lo = keys[i] + 1;
+                        }
+                    if (!next || next - 1 >= this->num_nodes.load(std::memory_order_relaxed))
+                        return;
+                    index = next - 1;
+                    version = wait_unlocked(this->node(index));
+                }
+            }
+        }
+
+        auto size() const noexcept -> std::size_t { return this->size_.load(std::memory_order_relaxed); }
+    private:
+        template <class T = Node>
+        auto node(const std::uint32_t index) const noexcept -> T& {
+            return *(T *)((char *)this + node_size * (1 + index));
+        }
+
+        template <class T>
+        auto new_node() noexcept -> std::uint32_t {
+            const auto index = this->num_nodes.load(std::memory_order_relaxed);
+            assert(index < this->max_nodes);
+            auto& node = *new(&this->template node<T>(index)) T{};
+            node.leaf = std::is_same_v<T, Leaf>;
+            this->num_nodes.store(index + 1, std::memory_order_relaxed);
+            return index;
+        }
+
+        static void lock(std::atomic<std::uint64_t>& version) noexcept {
+            version.store(version.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+        static void unlock(std::atomic<std::uint64_t>& version) noexcept {
+            version.store(version.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+        static void lock(Node& node) noexcept { lock(node.version); }
+        static void unlock(Node& node) noexcept { unlock(node.version); }
+
+        static auto wait_unlocked(const Node& node) noexcept {
+            auto version = node.version.load(std::memory_order_acquire);
+            for (; version & 1; version = node.version.load(std::memory_order_acquire))
+                std::this_thread::yield();
+            return version;
+        }
+        static bool validate(const Node& node, const std::uint64_t version) noexcept {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return node.version.load(std::memory_order_relaxed) == version;
+        }
+
+        /* 读者: 找到可能含有 `key` 的 leaf, 返回其序号和已读到的版本号. */
+        auto find_leaf(const key_type key) const noexcept -> std::pair<std::uint32_t, std::uint64_t> {
+        restart:
+            auto tree_version = this->version.load(std::memory_order_acquire);
+            if (tree_version & 1)
+                goto restart;
+            auto index = this->root.load(std::memory_order_acquire);
+            auto version = wait_unlocked(this->node(index));
+            if (this->version.load(std::memory_order_acquire) != tree_version)
+                goto restart;
+            while (!this->node(index).leaf) {
+                const auto& inner = this->template node<Inner>(index);
+                const auto child = inner.children[rank(inner.keys, std::min<std::size_t>(inner.count, Inner::capacity), key, true)];
+                if (child >= this->num_nodes.load(std::memory_order_relaxed))
+                    goto restart;  // 读到了撕裂的数据.
+                const auto child_version = wait_unlocked(this->node(child));
+                if (!validate(inner, version))
+                    goto restart;
+                index = child, version = child_version;
+            }
+            return {index, version};
+        }
+
+        /* 写者: 在已锁定的 leaf 的 `pos` 处插入; 满了则分裂, 返回新的右侧节点 (否则返回 0). */
+        auto split_insert(Leaf& leaf, const std::size_t pos, const key_type key, const Value& value, key_type& separator)
+        -> std::uint32_t {
+            key_type keys[Leaf::capacity + 1];
+            Value values[Leaf::capacity + 1];
+            std::copy_n(leaf.keys, pos, keys), std::copy(leaf.keys + pos, leaf.keys + leaf.count, keys + pos + 1);
+            std::copy_n(leaf.values, pos, values), std::copy(leaf.values + pos, leaf.values + leaf.count, values + pos + 1);
+            keys[pos] = key, values[pos] = value;
+            const auto total = leaf.count + 1uz;
+
+            if (total <= Leaf::capacity) {
+                std::copy_n(keys, total, leaf.keys), std::copy_n(values, total, leaf.values);
+                leaf.count = total;
+                return 0;
+            }
+            const auto right_index = this->template new_node<Leaf>();
+            auto& right = this->template node<Leaf>(right_index);
+            const auto half = total / 2;
+            std::copy_n(keys, half, leaf.keys), std::copy_n(values, half, leaf.values);
+            std::copy(keys + half, keys + total, right.keys), std::copy(values + half, values + total, right.values);
+            leaf.count = half, right.count = total - half;
+            right.next = leaf.next;
+            leaf.next = right_index + 1;
+            separator = right.keys[0];
+            return right_index;
+        }
+        /* 写者: 在已锁定的 inner 节点中, 将 `child` 插在 `slot` 右侧, 以 `separator` 隔开. */
+        auto split_insert(Inner& inner, const std::size_t slot, const key_type key, const std::uint32_t child, key_type& separator)
+        -> std::uint32_t {
+            key_type keys[Inner::capacity + 1];
+            std::uint32_t children[Inner::capacity + 2];
+            std::copy_n(inner.keys, slot, keys), std::copy(inner.keys + slot, inner.keys + inner.count, keys + slot + 1);
+            std::copy_n(inner.children, slot + 1, children), std::copy(inner.children + slot + 1, inner.children + inner.count + 1, children + slot + 2);
+            keys[slot] = key, children[slot + 1] = child;
+            const auto total = inner.count + 1uz;
+
+            if (total <= Inner::capacity) {
+                std::copy_n(keys, total, inner.keys), std::copy_n(children, total + 1, inner.children);
+                inner.count = total;
+                return 0;
+            }
+            const auto right_index = this->template new_node<Inner>();
+            auto& right = this->template node<Inner>(right_index);
+            const auto half = total / 2;  // `keys[half]` 被提升到上一层.
+            std::copy_n(keys, half, inner.keys), std::copy_n(children, half + 1, inner.children);
+            std::copy(keys + half + 1, keys + total, right.keys), std::copy(children + half + 1, children + total + 1, right.children);
+            inner.count = half, right.count = total - half - 1;
+            separator = keys[half];
+            return right_index;
+        }
+
+        /* 有序的 `keys` 中, 小于 (`inclusive` 时为不大于) `key` 的键的数量. */
+        static auto rank(const key_type *const keys, const std::size_t count, key_type key, const bool inclusive) noexcept
+        -> std::size_t {
+            if (inclusive) {
+                if (key == std::numeric_limits<key_type>::max())
+                    return count;
+                ++key;
+            }
+#ifdef __x86_64__
+            static const auto avx2 = (__builtin_cpu_init(), __builtin_cpu_supports("avx2"));
+            if (avx2)
+                return rank_avx2(keys, count, key);
+#endif
+            auto n = 0uz;
+            for (auto i = 0uz; i < count; ++i)
+                n += keys[i] < key;
+            return n;
+        }
+#ifdef __x86_64__
+        [[gnu::target("avx2")]]
+        static auto rank_avx2(const key_type *const keys, const std::size_t count, const key_type key) noexcept
+        -> std::size_t {
+            const auto needle = _mm256_set1_epi64x(key);
+            auto n = 0uz;
+            for (auto i = 0uz; i < count; i += 4) {
+                const auto less = _mm256_cmpgt_epi64(needle, _mm256_loadu_si256((const __m256i *)(keys + i)));
+                auto mask = unsigned(_mm256_movemask_pd(_mm256_castsi256_pd(less)));
+                if (count - i < 4)
+                    mask &= (1u << (count - i)) - 1;
+                n += std::popcount(mask);
+            }
+            return n;
+        }
+#endif
+};
+
+
+/**
+ * @brief 不可变的有序表, 用于在进程间共享只读的参考数据 (类似 SSTable).
+ * @details 由 `build` 一次性写入一块 `Shared_Memory`, 之后任何进程都可以经由
+ *          `ShM_Reader` 零拷贝地查询.  键和值分别存放在两个数组中 (SoA), 并按
+ *          Eytzinger (即 BFS) 顺序排列: 查找时从下标 1 出发, 每一步只需计算
+ *          `2k + (keys[k] < key)`, 没有难以预测的分支; 且前几层总是位于缓存中,
+ *          再配合提前数层的软件预取.  通常明显快于对同样的数据做 `std::lower_bound`
+ *          (见 `make bench`).
+ * @tparam Value 可平凡拷贝的值类型.
+ * @note example:
+ * ```
+ * std::vector<std::pair<std::int64_t, char>> entries;
+ * for (auto c = 'a'; c <= 'z'; ++c)
+ *     entries.emplace_back(c * 10, c);
+ * auto shm = ShM_Sorted_Table<char>::build("/ipcator.sorted-table", entries);
+ * // 其它进程:
+ * auto rd = ShM_Reader{};
+ * auto table = rd.template read<ShM_Sorted_Table<char>>("/ipcator.sorted-table", 0);
+ * assert( std::size(*table) == 26 );
+ * assert( *table->find('x' * 10) == 'x' && !table->find('x' * 10 + 1) );
+ * assert( table->lower_bound('x' * 10 + 1)->second == 'y' );
+ * assert( !table->lower_bound('z' * 10 + 1) );
+ * ```
+ */
+template <class Value>
+class ShM_Sorted_Table {
+        static_assert(std::is_trivially_copyable_v<Value>);
+    public:
+        using key_type = std::int64_t;
+    private:
+        std::size_t size_;
+
+        explicit ShM_Sorted_Table(const std::size_t size) noexcept: size_{size} {}
+
+        static auto keys_offset() noexcept { return cache_line_size; }
+        static auto values_offset(const std::size_t size) noexcept {
+            return ceil_to_cache_line_size(keys_offset() + (size + 1) * sizeof(key_type));
+        }
+        // 下标从 1 开始, 下标为 k 的节点的子节点是 2k 和 2k+1.
+        auto keys() const noexcept { return (const key_type *)((const char *)this + keys_offset()); }
+        auto values() const noexcept { return (const Value *)((const char *)this + values_offset(this->size_)); }
+    public:
+        ShM_Sorted_Table(const ShM_Sorted_Table&) = delete;
+        ShM_Sorted_Table& operator=(const ShM_Sorted_Table&) = delete;
+
+        /**
+         * @brief 将 `entries` 排序, 写入一块新建的 `Shared_Memory` (表位于偏移量 0 处).
+         * @param entries 由 (键, 值) 组成的序列, 无需有序.  重复的键只保留第一个.
+         */
+        static auto build(std::string name, const std::ranges::input_range auto& entries) -> Shared_Memory<true> {
+            std::vector<std::pair<key_type, Value>> sorted;
+            for (const auto& [key, value] : entries)
+                sorted.emplace_back(key, value);
+            std::ranges::stable_sort(sorted, {}, [](const auto& entry) { return entry.first; });
+            sorted.erase(
+                std::ranges::unique(sorted, {}, [](const auto& entry) { return entry.first; }).begin(),
+                std::end(sorted)
+            );
+
+            const auto size = std::size(sorted);
+            auto shm = Shared_Memory{
+                std::move(name),
+                ceil_to_page_size(values_offset(size) + (size + 1) * sizeof(Value))
+            };
+            const auto table = new(std::data(shm)) ShM_Sorted_Table{size};
+            const auto keys = (key_type *)table->keys();
+            const auto values = (Value *)table->values();
+            // 按中序遍历 Eytzinger 树, 恰好依次访问有序的元素:
+            auto k = 1uz;
+            while (2 * k <= size)
+                k *= 2;
+            for (const auto& [key, value] : sorted) {
+                keys[k] = key, values[k] = value;
+                if (2 * k + 1 <= size)  // 右子树中最左的节点.
+                    for (k = 2 * k + 1; 2 * k <= size; k *= 2);
+                else  // 第一个 “自己位于其左子树中” 的祖先.
+                    k >>= std::countr_one(k) + 1;
+            }
+            return shm;
+        }
+
+        auto size() const noexcept { return this->size_; }
+
+        auto find(const key_type key) const noexcept -> const Value * {
+            const auto k = this->search(key);
+            return k && this->keys()[k] == key ? &this->values()[k] : nullptr;
+        }
+
+        /**
+         * @brief 第一个键不小于 `key` 的条目.
+         */
+        auto lower_bound(const key_type key) const noexcept -> std::optional<std::pair<key_type, Value>> {
+            if (const auto k = this->search(key))
+                return std::pair{this->keys()[k], this->values()[k]};
+            else
+                return std::nullopt;
+        }
+    private:
+        /* 第一个不小于 `key` 的键的下标; 0 表示没有. */
+        auto search [[gnu::hot]] (const key_type key) const noexcept -> std::size_t {
+            const auto keys = this->keys();
+            auto k = 1uz;
+            while (k <= this->size_) {
+                // 同一缓存行中的 8 个键位于 3 层之后; 预取 4 层之后的:
+                __builtin_prefetch(keys + 16 * k);
+                k = 2 * k + (keys[k] < key);
+            }
+            // 去掉最后若干次 “向右走” 以及再之前的那一次 “向左走”:
+            return k >> (std::countr_one(k) + 1);
+        }
+};
+
+
+/**
+ * @brief `ShM_MVCC_Store` 的配置选项.
+ */
+struct ShM_MVCC_Store_Options {
+    std::size_t objects = 1024;  ///< 对象的数量; 对象以 [0, `objects`) 中的序号标识.
+    std::size_t versions = 4096;  ///< 所有对象的版本总数的上限.
+    std::size_t readers = 64;  ///< 同时存在的快照的数量上限.
+};
+
+
+/**
+ * @brief 位于 shared memory 中的多版本 (MVCC) 对象存储: 一个写者持续更新, 其它
+ *        进程中的读者看到的是多个对象的一致快照.
+ * @details 每个对象有一条从新到旧的版本链, 每个版本带有提交它的时间戳.  写者的
+ *          `write` 立即把新版本挂到链首, 但它的时间戳比全局的提交时间戳大 1, 在
+ *          `commit` 递增全局时间戳之前对读者不可见; 因此一次 `commit` 之前的所有
+ *          写入原子地生效.  读者 `pin` 当前的提交时间戳, 沿着版本链找到不晚于它的
+ *          第一个版本, 全程不加锁.  快照登记在 shared memory 中, 写者 `reclaim`
+ *          时只回收所有快照都不再需要的旧版本.
+ * @tparam T 可平凡拷贝的对象类型.
+ * @note 读者需要以可写的方式 (`ShM_Reader<true>`) 访问, 以便登记快照.
+ * @warning 回收的界限是最旧的快照: 长期持有的快照会使在它之后被覆盖的版本都无法
+ *          回收, 进而导致 `write` 因版本用尽而失败.
+ * @note example:
+ * ```
+ * auto pool = ShM_Pool<false>{};
+ * auto& store = ShM_MVCC_Store<int>::create(pool, {.objects = 2, .versions = 4, .readers = 2});
+ * assert( !store.pin().read(0) );  // 尚未提交.
+ * store.write(0, 100), store.write(1, 0);
+ * store.commit();
+ * // 其它进程:
+ * const auto& arena = pool.upstream_resource()->find_arena(&store);
+ * auto rd = ShM_Reader<true>{};
+ * auto other = rd.template read<ShM_MVCC_Store<int>>(arena.get_name(), (char *)&store - std::data(arena));
+ * {
+ *     const auto snapshot = other->pin();
+ *     store.write(0, 70), store.write(1, 30);  // 一次转账.
+ *     assert( *snapshot.read(0) + *snapshot.read(1) == 100 );
+ *     store.commit();
+ *     assert( *snapshot.read(0) == 100 );  // 快照不变.
+ *     assert( *other->pin().read(0) == 70 );
+ *     assert( store.reclaim() == 0 );  // 旧版本仍被快照需要.
+ * }
+ * assert( store.reclaim() == 2 );
+ * ```
+ */
+template <class T>
+class ShM_MVCC_Store {
+        static_assert(std::is_trivially_copyable_v<T>);
+
+        struct Version {
+            std::uint64_t timestamp;
+            std::uint32_t prev;  // 更旧的版本的序号 + 1; 0 表示没有.
+            T value;
+        };
+        struct alignas(cache_line_size) Pin {
+            std::atomic<std::uint64_t> timestamp;  // 0: 空闲; UINT64_MAX: 正在登记.
+        };
+        static constexpr auto unpinned = std::uint64_t{0}, pinning = UINT64_MAX;
+
+        // 从 1 开始: 首次提交之前的快照登记的时间戳不能与 `unpinned` 相同.
+        std::atomic<std::uint64_t> commit_timestamp{1};
+        std::uint32_t num_objects, num_versions, num_readers;
+        std::uint32_t free_list;  // 仅由写者访问.
+
+        explicit ShM_MVCC_Store(const ShM_MVCC_Store_Options& options) noexcept
+        : num_objects(options.objects), num_versions(options.versions), num_readers(options.readers),
+          free_list(options.versions ? 1 : 0) {
+            assert(std::max({options.objects, options.versions, options.readers}) <= UINT32_MAX);
+        }
+
+        auto pins() const noexcept {
+            return std::span{(Pin *)((char *)this + ceil_to_cache_line_size(sizeof(ShM_MVCC_Store))), this->num_readers};
+        }
+        auto heads() const noexcept {
+            return std::span{(std::atomic<std::uint32_t> *)std::to_address(std::end(this->pins())), this->num_objects};
+        }
+        auto versions() const noexcept {
+            const auto heads_end = std::uintptr_t(std::to_address(std::end(this->heads())));
+            return std::span{
+                (Version *)((heads_end + alignof(Version) - 1) / alignof(Version) * alignof(Version)),
+                this->num_versions
+            };
+        }
+    public:
+        ShM_MVCC_Store(const ShM_MVCC_Store&) = delete;
+        ShM_MVCC_Store& operator=(const ShM_MVCC_Store&) = delete;
+
+        static auto size_for(const ShM_MVCC_Store_Options& options) noexcept -> std::size_t {
+            const ShM_MVCC_Store layout{options};  // 只用于计算布局.
+            return (char *)std::to_address(std::end(layout.versions())) - (char *)&layout;
+        }
+
+        /**
+         * @brief 在 `area` (至少 `size_for(options)` 字节, 按缓存行对齐) 处构造存储.
+         */
+        static auto create(void *const area, const ShM_MVCC_Store_Options& options) -> ShM_MVCC_Store& {
+            assert(std::uintptr_t(area) % cache_line_size == 0);
+            auto& store = *new(area) ShM_MVCC_Store{options};
+            std::uninitialized_value_construct(std::begin(store.pins()), std::end(store.pins()));
+            std::uninitialized_value_construct(std::begin(store.heads()), std::end(store.heads()));
+            for (auto i = 0u; auto& version : store.versions())
+                version.prev = ++i < store.num_versions ? i + 1 : 0;  // 起初都在空闲链表中.
+            return store;
+        }
+        /**
+         * @brief 从共享内存分配器 (例如 `ShM_Pool`) 中分配并构造存储.
+         */
+        static auto create(IPCator auto& allocator, const ShM_MVCC_Store_Options& options) -> ShM_MVCC_Store& {
+            return ShM_MVCC_Store::create(allocator.allocate(size_for(options), cache_line_size), options);
+        }
+
+        /**
+         * @brief 写者: 更新对象, 在下一次 `commit` 时生效.
+         * @exception 版本用尽 (且 `reclaim` 也无法腾出) 时抛出 `std::bad_alloc`.
+         */
+        void write(const std::size_t object, const T& value) {
+            assert(object < this->num_objects);
+            const auto pending = this->commit_timestamp.load(std::memory_order_relaxed) + 1;
+            auto& head = this->heads()[object];
+            const auto newest = head.load(std::memory_order_relaxed);
+            if (newest && this->versions()[newest - 1].timestamp == pending) {
+                // 本次提交中已经写过, 读者不会访问它:
+                this->versions()[newest - 1].value = value;
+                return;
+            }
+            if (!this->free_list && !this->reclaim())
+                throw std::bad_alloc{};
+            const auto index = this->free_list - 1;
+            auto& version = this->versions()[index];
+            this->free_list = version.prev;
+            version.timestamp = pending;
+            version.prev = newest;
+            version.value = value;
+            head.store(index + 1, std::memory_order_release);
+        }
+
+        /**
+         * @brief 写者: 使之前的所有 `write` 原子地对新的快照可见.
+         * @return 新的提交时间戳.
+         */
+        auto commit() noexcept {
+            const auto timestamp = this->commit_timestamp.load(std::memory_order_relaxed) + 1;
+            this->commit_timestamp.store(timestamp, std::memory_order_seq_cst);
+            return timestamp;
+        }
+
+        /**
+         * @brief 写者: 回收所有快照都不再需要的旧版本.
+         * @return 回收的版本数.
+         */
+        auto reclaim() noexcept -> std::size_t {
+            // 比任何现存的和将来的快照都旧的时间戳:
+            auto horizon = this->commit_timestamp.load(std::memory_order_seq_cst);
+            for (const auto& pin : this->pins())
+                if (const auto timestamp = pin.timestamp.load(std::memory_order_seq_cst); timestamp != unpinned)
+                    horizon = std::min(horizon, timestamp);
+
+            auto reclaimed = 0uz;
+            for (const auto& head : this->heads()) {
+                // 找到在 `horizon` 时刻可见的版本, 比它更旧的都可以回收:
+                auto index = head.load(std::memory_order_relaxed);
+                while (index && this->versions()[index - 1].timestamp > horizon)
+                    index = this->versions()[index - 1].prev;
+                if (!index)
+                    continue;
+                for (auto old = std::exchange(this->versions()[index - 1].prev, 0); old; ++reclaimed) {
+                    auto& version = this->versions()[old - 1];
+                    old = std::exchange(version.prev, std::exchange(this->free_list, old));
+                }
+            }
+            return reclaimed;
+        }
+
+        auto timestamp() const noexcept {
+            return this->commit_timestamp.load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief 读者持有的快照.  析构时撤销登记.
+         */
+        class Snapshot {
+                friend ShM_MVCC_Store;
+                const ShM_MVCC_Store *store;
+                Pin *pin;
+                std::uint64_t timestamp_;
+                Snapshot(const ShM_MVCC_Store& store, Pin& pin, const std::uint64_t timestamp) noexcept
+                : store{&store}, pin{&pin}, timestamp_{timestamp} {}
+            public:
+                Snapshot(Snapshot&& other) noexcept
+                : store{other.store}, pin{std::exchange(other.pin, nullptr)}, timestamp_{other.timestamp_} {}
+                Snapshot& operator=(Snapshot other) noexcept {
+                    std::swap(this->store, other.store);
+                    std::swap(this->pin, other.pin);
+                    std::swap(this->timestamp_, other.timestamp_);
+                    return *this;
+                }
+                ~Snapshot() {
+                    if (this->pin)
+                        this->pin->timestamp.store(unpinned, std::memory_order_release);
+                }
+
+                auto timestamp() const noexcept { return this->timestamp_; }
+
+                /**
+                 * @brief 对象在该快照中的值.  对象尚未被写过时返回 `nullptr`.
+                 * @note 返回的指针在快照析构之前一直有效.
+                 */
+                auto read(const std::size_t object) const noexcept -> const T * {
+                    assert(object < this->store->num_objects);
+                    for (
+                        auto index = this->store->heads()[object].load(std::memory_order_acquire);
+                        index; index = this->store->versions()[index - 1].prev
+                    )
+                        if (const auto& version = this->store->versions()[index - 1]; version.timestamp <= this->timestamp_)
+                            return &version.value;
+                    return nullptr;
+                }
+        };
+
+        /**
+         * @brief 读者: 以当前的提交时间戳创建快照.  所有登记位都被占用时等待.
+         */
+        auto pin() const -> Snapshot {
+            for (auto tries = 0uz; true; ++tries) {
+                auto& pin = this->pins()[tries % this->num_readers];
+                auto expected = unpinned;
+                if (!pin.timestamp.compare_exchange_strong(expected, pinning, std::memory_order_relaxed)) {
+                    if (tries % this->num_readers == this->num_readers - 1)
+                        std::this_thread::yield();
+                    continue;
+                }
+                // 登记之后再次确认提交时间戳未变, 这样 `reclaim` 一定能看到该登记:
+                for (auto timestamp = this->timestamp(); true; ) {
+                    pin.timestamp.store(timestamp, std::memory_order_seq_cst);
+                    if (const auto now = this->commit_timestamp.load(std::memory_order_seq_cst); now == timestamp)
+                        return Snapshot{*this, pin, timestamp};
+                    else
+                        timestamp = now;
+                }
+            }
+        }
+};
+
+
+struct ShM_Commit_Log_Options {
+    std::size_t records = 64;  ///< 保留的最近的提交记录的数量.
+    std::size_t blocks = 8;  ///< 每条提交记录最多引用的块数.
+};
+
+
+/**
+ * @brief 位于 shared memory 中的提交记录环: 写者把多个块 (例如表头和若干数组)
+ *        作为一个整体发布, 其它进程中的读者要么看到全部, 要么一个也看不到.
+ * @details 写者先在共享内存分配器中填好所有的块, 再调用 `publish` 写入一条引用
+ *          这些块 (段名 + 偏移量 + 大小) 的记录, 最后以一次 release store 推进
+ *          序列号.  读者以一次 acquire load 得到序列号, 此后对记录所引用的块的
+ *          读取都不需要额外的同步: 每批只有一个屏障, 而不是每个块一个标志位.
+ *          记录位于容量为 `records` 的环中, 每条记录带有 seqlock 式的戳, 被写者
+ *          覆盖的旧记录会被读者识别出来.
+ * @note 写者负责块的生命周期: 被环中的记录引用的块不应被回收或修改.  配合只增不
+ *       减的 `Monotonic_ShM_Buffer` 最为自然.
+ * @note example:
+ * ```
+ * auto buffer = Monotonic_ShM_Buffer{};
+ * auto& log = ShM_Commit_Log::create(buffer, {.records = 4, .blocks = 2});
+ * const auto header = (std::size_t *)buffer.allocate(sizeof(std::size_t));
+ * const auto payload = (double *)buffer.allocate(3 * sizeof(double));
+ * *header = 3, payload[0] = 0.5, payload[1] = 1.5, payload[2] = 2.5;
+ * log.publish(buffer, {std::as_bytes(std::span{header, 1}), std::as_bytes(std::span{payload, 3})});
+ * // 其它进程:
+ * const auto& arena = buffer.upstream_resource()->find_arena(&log);
+ * auto rd = ShM_Reader{};
+ * auto other = rd.template read<ShM_Commit_Log>(arena.get_name(), (char *)&log - std::data(arena));
+ * const auto record = other->latest();
+ * assert( record && record->sequence == 1 && std::size(record->blocks) == 2 );
+ * const auto& [segment, offset, size] = record->blocks[1];
+ * assert( size == 3 * sizeof(double) );
+ * assert( std::to_address(rd.template read<double>(std::data(segment), offset))[2] == 2.5 );
+ * ```
+ */
+class ShM_Commit_Log {
+    public:
+        /**
+         * @brief 记录所引用的块: 所在的段的名字, 块在段中的偏移量, 块的大小.
+         */
+        struct Block {
+            std::array<char, 24> segment;
+            std::size_t offset, size;
+        };
+        struct Record {
+            std::uint64_t sequence;
+            std::vector<Block> blocks;
+        };
+    private:
+        struct Slot {
+            std::atomic<std::uint64_t> stamp;  // 2 * 序列号; 写入期间为奇数.
+            std::size_t count;
+        };
+
+        std::atomic<std::uint64_t> head{};  // 最新发布的记录的序列号; 0 表示没有.
+        std::size_t num_records, max_blocks;
+
+        explicit ShM_Commit_Log(const ShM_Commit_Log_Options& options) noexcept
+        : num_records(options.records), max_blocks(options.blocks) {
+            assert(options.records);
+        }
+
+        auto slot_stride() const noexcept {
+            return ceil_to_cache_line_size(sizeof(Slot) + this->max_blocks * sizeof(Block));
+        }
+        auto slot(const std::uint64_t sequence) const noexcept -> Slot& {
+            return *(Slot *)(
+                (char *)this + ceil_to_cache_line_size(sizeof(ShM_Commit_Log))
+                + (sequence - 1) % this->num_records * this->slot_stride()
+            );
+        }
+        static auto blocks_of(const Slot& slot) noexcept {
+            return (Block *)(&slot + 1);
+        }
+    public:
+        ShM_Commit_Log(const ShM_Commit_Log&) = delete;
+        ShM_Commit_Log& operator=(const ShM_Commit_Log&) = delete;
+
+        static auto size_for(const ShM_Commit_Log_Options& options) noexcept -> std::size_t {
+            const ShM_Commit_Log layout{options};  // 只用于计算布局.
+            return ceil_to_cache_line_size(sizeof(ShM_Commit_Log)) + options.records * layout.slot_stride();
+        }
+
+        /**
+         * @brief 在 `area` (至少 `size_for(options)` 字节, 按缓存行对齐) 处构造提交记录环.
+         */
+        static auto create(void *const area, const ShM_Commit_Log_Options& options) -> ShM_Commit_Log& {
+            assert(std::uintptr_t(area) % cache_line_size == 0);
+            auto& log = *new(area) ShM_Commit_Log{options};
+            for (auto sequence = 1uz; sequence <= options.records; ++sequence)
+                new(&log.slot(sequence)) Slot{};
+            return log;
+        }
+        /**
+         * @brief 从共享内存分配器 (例如 `Monotonic_ShM_Buffer`) 中分配并构造提交记录环.
+         */
+        static auto create(IPCator auto& allocator, const ShM_Commit_Log_Options& options) -> ShM_Commit_Log& {
+            return ShM_Commit_Log::create(allocator.allocate(size_for(options), cache_line_size), options);
+        }
+
+        /**
+         * @brief 写者: 发布一条引用 `blocks` 的记录.  在此之前对这些块的所有写入
+         *        都对读到该记录的读者可见.
+         * @return 记录的序列号, 从 1 开始.
+         */
+        auto publish(const std::span<const Block> blocks) noexcept -> std::uint64_t {
+            assert(std::size(blocks) <= this->max_blocks);
+            const auto sequence = this->head.load(std::memory_order_relaxed) + 1;
+            auto& slot = this->slot(sequence);
+            slot.stamp.store(2 * sequence - 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            slot.count = std::size(blocks);
+            std::ranges::copy(blocks, blocks_of(slot));
+            slot.stamp.store(2 * sequence, std::memory_order_release);
+            this->head.store(sequence, std::memory_order_release);  // 唯一的发布点.
+            return sequence;
+        }
+        /**
+         * @brief 写者: 发布一条引用 `blocks` 的记录, 其中每个块都来自 `allocator`.
+         * @exception 块不属于 `allocator` 时, 由 `find_arena` 抛出异常.
+         */
+        auto publish(
+            const IPCator auto& allocator, const std::initializer_list<std::span<const std::byte>> blocks
+        ) -> std::uint64_t {
+            std::vector<Block> descriptors;
+            descriptors.reserve(std::size(blocks));
+            for (const auto block : blocks) {
+                const auto& arena = [&]() -> auto& {
+                    if constexpr (requires { allocator.find_arena(std::data(block)); })
+                        return allocator.find_arena(std::data(block));
+                    else
+                        return allocator.upstream_resource()->find_arena(std::data(block));
+                }();
+                auto& descriptor = descriptors.emplace_back(
+                    Block{{}, std::size_t((const char *)std::data(block) - std::data(arena)), std::size(block)}
+                );
+                assert(std::size(arena.get_name()) < std::size(descriptor.segment));
+                std::ranges::copy(arena.get_name(), std::data(descriptor.segment));
+            }
+            return this->publish(descriptors);
+        }
+
+        /**
+         * @brief 最新发布的记录的序列号.  为 0 时表示尚无记录.
+         */
+        auto sequence() const noexcept {
+            return this->head.load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief 读者: 拷贝序列号为 `sequence` 的记录.
+         * @return 记录尚未发布, 或已被覆盖时返回 `std::nullopt`.
+         */
+        auto get(const std::uint64_t sequence) const -> std::optional<Record> {
+            if (!sequence || sequence > this->sequence())
+                return std::nullopt;
+            const auto& slot = this->slot(sequence);
+            if (slot.stamp.load(std::memory_order_acquire) != 2 * sequence)
+                return std::nullopt;
+            const auto count = std::min(slot.count, this->max_blocks);
+            std::optional<Record> record{std::in_place, sequence, std::vector<Block>(count)};
+            std::memcpy(std::data(record->blocks), blocks_of(slot), count * sizeof(Block));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.stamp.load(std::memory_order_relaxed) != 2 * sequence)
+                return std::nullopt;
+            return record;
+        }
+
+        /**
+         * @brief 读者: 拷贝最新发布的记录.  尚无记录时返回 `std::nullopt`.
+         */
+        auto latest() const -> std::optional<Record> {
+            while (const auto sequence = this->sequence())
+                if (auto record = this->get(sequence))
+                    return record;
+            return std::nullopt;
+        }
+};
+
+
+struct ShM_Delta_Channel_Options {
+    std::size_t size = {};  ///< 被发布的结构的字节数.
+    std::size_t capacity = 1 << 20;  ///< 补丁环的字节数; 应能容纳一次 `publish` 的全部补丁.
+};
+
+
+/**
+ * @brief 位于 shared memory 中的增量发布通道: 大块结构只有一小部分变化时, 写者只
+ *        发布变化了的字节范围, 读者把这些补丁打到自己的私有副本上.
+ * @details 通道中有两部分:
+ *          - 补丁环: 每个补丁是 (偏移量, 长度, 数据).  一次 `publish` 的所有补丁
+ *            写完之后, 以一次 release store 推进环的写入位置, 因此读者的副本
+ *            总是停在某次 `publish` 的边界上.
+ *          - 完整快照: 写者在推进写入位置之后, 把同样的补丁打到快照上.  读者第一
+ *            次同步, 或落后太多 (需要的补丁已被覆盖) 时, 拷贝快照, 再重放拷贝
+ *            期间发布的补丁, 得到一致的副本; 写者不需要为此暂停.
+ * @note 读者需要的只是一块与结构等长的私有内存, 例如 `std::vector<char>`.
+ * @note example:
+ * ```
+ * auto pool = ShM_Pool<false>{};
+ * auto& channel = ShM_Delta_Channel::create(pool, {.size = 1 << 20, .capacity = 4096});
+ * std::vector<char> structure(1 << 20);
+ * // 其它进程:
+ * const auto& arena = pool.upstream_resource()->find_arena(&channel);
+ * auto rd = ShM_Reader{};
+ * auto other = rd.template read<ShM_Delta_Channel>(arena.get_name(), (char *)&channel - std::data(arena));
+ * std::vector<char> replica(1 << 20);
+ * auto position = std::optional<std::uint64_t>{};
+ * assert( other->sync(replica, position) == std::size(replica) );  // 第一次: 拷贝快照.
+ *
+ * structure[42] = 'a', structure[1000] = 'b';
+ * channel.publish(structure, {{42, 1}, {1000, 1}});
+ * assert( other->sync(replica, position) == 2 );  // 之后: 只拷贝补丁.
+ * assert( replica == structure );
+ * ```
+ */
+class ShM_Delta_Channel {
+        struct Patch {
+            std::uint64_t offset, size;
+        };
+        static constexpr auto patch_alignment = alignof(Patch);
+
+        std::atomic<std::uint64_t> reserved{};  // 写者将要写到的位置; 之前 `capacity` 字节以外的补丁已失效.
+        std::atomic<std::uint64_t> published{};  // 补丁环中已发布的位置.
+        std::atomic<std::uint64_t> snapshot_position{};  // 快照已包含此位置之前的全部补丁.
+        std::size_t size_, capacity_;
+
+        explicit ShM_Delta_Channel(const ShM_Delta_Channel_Options& options) noexcept
+        : size_(options.size), capacity_(options.capacity) {
+            assert(options.capacity && options.capacity % patch_alignment == 0);
+        }
+
+        auto snapshot() const noexcept {
+            return std::span{(char *)this + ceil_to_cache_line_size(sizeof(ShM_Delta_Channel)), this->size_};
+        }
+        auto ring() const noexcept {
+            return std::span{
+                std::to_address(std::begin(this->snapshot())) + ceil_to_cache_line_size(this->size_), this->capacity_
+            };
+        }
+        static constexpr auto patch_bytes(const std::size_t size) noexcept -> std::size_t {
+            return sizeof(Patch) + (size + patch_alignment - 1) / patch_alignment * patch_alignment;
+        }
+        /* 环上的拷贝可能绕回开头, 分为两段. */
+        void ring_write(const std::uint64_t position, const void *const src, const std::size_t n) noexcept {
+            const auto at = position % this->capacity_, first = std::min(n, this->capacity_ - at);
+            std::memcpy(std::data(this->ring()) + at, src, first);
+            std::memcpy(std::data(this->ring()), (const char *)src + first, n - first);
+        }
+        void ring_read(const std::uint64_t position, void *const dst, const std::size_t n) const noexcept {
+            const auto at = position % this->capacity_, first = std::min(n, this->capacity_ - at);
+            std::memcpy(dst, std::data(this->ring()) + at, first);
+            std::memcpy((char *)dst + first, std::data(this->ring()), n - first);
+        }
+        /* 读到的 [`position`, ...) 是否尚未被写者覆盖. */
+        auto intact(const std::uint64_t position) const noexcept {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return this->reserved.load(std::memory_order_relaxed) - position <= this->capacity_;
+        }
+
+        /* 将 [`from`, `to`) 中的补丁打到 `replica` 上; 补丁已被覆盖时返回 `std::nullopt`. */
+        auto replay(const std::span<char> replica, std::uint64_t from, const std::uint64_t to) const noexcept
+        -> std::optional<std::size_t> {
+            auto applied = 0uz;
+            while (from != to) {
+                Patch patch;
+                this->ring_read(from, &patch, sizeof(Patch));
+                if (!this->intact(from) || patch.offset > this->size_ || patch.size > this->size_ - patch.offset)
+                    return std::nullopt;
+                this->ring_read(from + sizeof(Patch), std::data(replica) + patch.offset, patch.size);
+                if (!this->intact(from))
+                    return std::nullopt;
+                applied += patch.size;
+                from += patch_bytes(patch.size);
+            }
+            return applied;
+        }
+    public:
+        ShM_Delta_Channel(const ShM_Delta_Channel&) = delete;
+        ShM_Delta_Channel& operator=(const ShM_Delta_Channel&) = delete;
+
+        static auto size_for(const ShM_Delta_Channel_Options& options) noexcept -> std::size_t {
+            return ceil_to_cache_line_size(sizeof(ShM_Delta_Channel)) + ceil_to_cache_line_size(options.size)
+                   + options.capacity;
+        }
+
+        /**
+         * @brief 在 `area` (至少 `size_for(options)` 字节, 按缓存行对齐) 处构造通道.
+         *        快照的初始内容全为 0.
+         */
+        static auto create(void *const area, const ShM_Delta_Channel_Options& options) -> ShM_Delta_Channel& {
+            assert(std::uintptr_t(area) % cache_line_size == 0);
+            auto& channel = *new(area) ShM_Delta_Channel{options};
+            std::ranges::fill(channel.snapshot(), 0);
+            return channel;
+        }
+        /**
+         * @brief 从共享内存分配器 (例如 `ShM_Pool`) 中分配并构造通道.
+         */
+        static auto create(IPCator auto& allocator, const ShM_Delta_Channel_Options& options) -> ShM_Delta_Channel& {
+            return ShM_Delta_Channel::create(allocator.allocate(size_for(options), cache_line_size), options);
+        }
+
+        auto size() const noexcept { return this->size_; }
+        auto capacity() const noexcept { return this->capacity_; }
+
+        /**
+         * @brief 写者: 发布 `source` 中变化了的范围.
+         * @param source 结构的当前内容, 长度为 `size()`.
+         * @param ranges 变化了的 (偏移量, 长度).
+         * @return 发布之后的补丁环位置.
+         * @note 补丁总量超出 `capacity()` 时, 改为 `refresh`.
+         */
+        auto publish(
+            const std::span<const char> source, const std::span<const std::pair<std::size_t, std::size_t>> ranges
+        ) noexcept -> std::uint64_t {
+            assert(std::size(source) == this->size_);
+            auto total = 0uz;
+            for (const auto& [offset, size] : ranges) {
+                assert(offset <= this->size_ && size <= this->size_ - offset);
+                total += patch_bytes(size);
+            }
+            if (total > this->capacity_)
+                return this->refresh(source);
+
+            const auto from = this->published.load(std::memory_order_relaxed), to = from + total;
+            this->reserved.store(to, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            for (auto position = from; const auto& [offset, size] : ranges) {
+                const Patch patch{offset, size};
+                this->ring_write(position, &patch, sizeof(Patch));
+                this->ring_write(position + sizeof(Patch), std::data(source) + offset, size);
+                position += patch_bytes(size);
+            }
+            this->published.store(to, std::memory_order_release);  // 一次发布整批补丁.
+
+            // 快照的写入必须在发布之后, 这样读到它们的读者一定也能看到相应的补丁:
+            std::atomic_thread_fence(std::memory_order_release);
+            for (const auto& [offset, size] : ranges)
+                std::memcpy(std::data(this->snapshot()) + offset, std::data(source) + offset, size);
+            this->snapshot_position.store(to, std::memory_order_release);
+            return to;
+        }
+        auto publish(
+            const std::span<const char> source, const std::initializer_list<std::pair<std::size_t, std::size_t>> ranges
+        ) noexcept -> std::uint64_t {
+            return this->publish(source, std::span{ranges});
+        }
+        /**
+         * @brief 写者: 发布 `tracker` 发现的脏页 (与 `source` 重叠的部分), 并以当前
+         *        状态作为它的新基准.
+         * @param tracker 追踪 `source` 所在的 shared memory; `source` 不必从页面边界开始.
+         * @warning `tracker` 使用 soft-dirty 时, 发布期间写入方必须暂停, 见 `Dirty_Page_Tracker`.
+         * @note example:
+         * ```
+         * const auto page = ::getpagesize() + 0uz;
+         * auto shm = Shared_Memory{"/ipcator.delta-tracked", 4 * page};
+         * const auto source = std::span{shm}.subspan(page / 2, 2 * page);  // 例如池子中的一个对象.
+         * auto tracker = Dirty_Page_Tracker{shm};
+         * auto pool = ShM_Pool<false>{};
+         * auto& channel = ShM_Delta_Channel::create(pool, {.size = std::size(source), .capacity = 4 * page});
+         * channel.publish(source, tracker);  // 第一次: 所有页面都是脏页.
+         * std::vector<char> replica(std::size(source));
+         * auto position = std::optional<std::uint64_t>{};
+         * const auto copied = channel.sync(replica, position);
+         * assert( copied == std::size(source) );
+         * source[page - 1] = 'x';  // 位于 `shm` 的第 1 页, 即 `source` 的 [page/2, 3page/2).
+         * channel.publish(source, tracker);
+         * const auto patched = channel.sync(replica, position);
+         * assert( patched == page && std::ranges::equal(replica, source) );
+         * ```
+         */
+        auto publish(const std::span<const char> source, Dirty_Page_Tracker& tracker) -> std::uint64_t {
+            const auto region = tracker.tracked_region();
+            assert(
+                std::data(region) <= std::data(source)
+                && std::data(source) + std::size(source) <= std::data(region) + std::size(region)
+            );
+            // 页面的序号相对于 `region`, 需要换算成相对于 `source` 的偏移量:
+            const auto base = std::size_t(std::data(source) - std::data(region));
+            const auto page_size = ::getpagesize() + 0uz;
+            std::vector<std::pair<std::size_t, std::size_t>> ranges;
+            for (const auto page : tracker.dirty_pages(true)) {
+                const auto begin = std::max(page * page_size, base),
+                           end = std::min((page + 1) * page_size, base + this->size_);
+                if (begin >= end)
+                    continue;
+                if (!ranges.empty() && ranges.back().first + ranges.back().second == begin - base)
+                    ranges.back().second += end - begin;  // 合并相邻的脏页.
+                else
+                    ranges.emplace_back(begin - base, end - begin);
+            }
+            return this->publish(source, ranges);
+        }
+
+        /**
+         * @brief 写者: 整体替换快照.  所有读者在下次 `sync` 时都会重新拷贝快照.
+         * @return 替换之后的补丁环位置.
+         */
+        auto refresh(const std::span<const char> source) noexcept -> std::uint64_t {
+            assert(std::size(source) == this->size_);
+            // 跳过一整圈, 使环中现有的补丁全部失效:
+            const auto to = this->published.load(std::memory_order_relaxed) + this->capacity_ + patch_alignment;
+            this->reserved.store(to, std::memory_order_relaxed);
+            this->published.store(to, std::memory_order_release);
+            std::atomic_thread_fence(std::memory_order_release);
+            std::ranges::copy(source, std::begin(this->snapshot()));
+            this->snapshot_position.store(to, std::memory_order_release);
+            return to;
+        }
+
+        /**
+         * @brief 读者: 使私有副本 `replica` 与最新发布的内容一致.
+         * @param replica 长度为 `size()` 的私有内存.
+         * @param position 副本所处的补丁环位置; 初始为空, 由本函数维护.
+         * @return 拷贝到 `replica` 中的字节数.
+         * @note 通常只拷贝补丁; 副本落后太多或尚未同步过时, 拷贝整个快照.
+         *       写者持续 `refresh` 时, 读者会等待.
+         */
+        auto sync(const std::span<char> replica, std::optional<std::uint64_t>& position) const -> std::size_t {
+            assert(std::size(replica) == this->size_);
+            if (position) {
+                const auto to = this->published.load(std::memory_order_acquire);
+                if (const auto applied = this->replay(replica, *position, to)) {
+                    position = to;
+                    return *applied;
+                }
+            }
+            while (true) {
+                const auto from = this->snapshot_position.load(std::memory_order_acquire);
+                std::memcpy(std::data(replica), std::data(this->snapshot()), this->size_);
+                // 拷贝期间被写入快照的字节, 都属于 `to` 之前的补丁; 重放它们即可修正:
+                std::atomic_thread_fence(std::memory_order_acquire);
+                const auto to = this->published.load(std::memory_order_relaxed);
+                if (const auto applied = this->replay(replica, from, to)) {
+                    position = to;
+                    return this->size_ + *applied;
+                }
+                std::this_thread::yield();
+            }
+        }
+};
+
+
+/**
+ * @brief 在进程间共享机器码 (预编译的内核, JIT 的输出等), 且遵守 W^X.
+ * @details 写者通过可读写但不可执行的映射写入代码; 读者通过 `ShM_Reader` 对同一
+ *          目标文件的只读映射执行它, 只读映射带有 `PROT_EXEC`.  任何映射都不会同时
+ *          可写又可执行, 因此在禁止 `PROT_WRITE | PROT_EXEC` 的加固环境中也能工作,
+ *          且无需拷贝.  写者写入后清理数据缓存, 读者在 `load` 时使指令缓存失效
+ *          (都通过 `__builtin___clear_cache`; 在 x86 上无需任何操作).
+ * @note `/dev/shm` 以 `noexec` 挂载时, 只读映射也无法获得 `PROT_EXEC` (`load` 会
+ *       抛出异常); 此时应以可执行的文件系统中的文件路径作为名字 (见
+ *       `POSIX::is_file_path`).
+ * @warning 代码必须是位置无关的, 不能引用写者进程中的地址.
+ * @note example:
+ * ```
+ * // x86-64 上的 `int twice(int n) { return 2 * n; }`, 即 `lea eax, [rdi + rdi]; ret`:
+ * constexpr unsigned char twice[]{0x8d, 0x04, 0x3f, 0xc3};
+ * auto cache = ShM_Code_Cache{"/ipcator.code-cache", 4096};
+ * const auto offset = cache.add(std::as_bytes(std::span{twice}));
+ * // 其它进程:
+ * auto rd = ShM_Reader{};
+ * const auto fn = ShM_Code_Cache::load<int(int)>(rd, "/ipcator.code-cache", offset);
+ * assert( (*fn)(21) == 42 );
+ * ```
+ */
+class ShM_Code_Cache {
+        Shared_Memory<true> segment;
+        std::size_t used = 0;
+    public:
+        /**
+         * @param name 同 `Shared_Memory::Shared_Memory(std::string, std::size_t, std::size_t)`.
+         * @param capacity 可容纳的代码的总字节数.
+         */
+        explicit ShM_Code_Cache(std::string name, const std::size_t capacity = 1 << 20)
+        : segment{std::move(name), capacity} {}
+
+        auto& get_name() const noexcept { return this->segment.get_name(); }
+
+        /**
+         * @brief 写者: 写入一段代码.
+         * @return 代码在目标文件中的偏移量, 供读者 `load`.
+         * @exception 空间不足时抛出 `std::bad_alloc`.
+         */
+        auto add(const std::span<const std::byte> code, const std::size_t alignment = cache_line_size)
+        -> std::size_t {
+            assert(std::has_single_bit(alignment));
+            // 代码之前存放它的长度, 供读者使指令缓存失效:
+            const auto offset = (this->used + sizeof(std::size_t) + alignment - 1) / alignment * alignment;
+            if (offset + std::size(code) > std::size(this->segment))
+                throw std::bad_alloc{};
+            const auto dst = std::data(this->segment) + offset;
+            const auto size = std::size(code);
+            std::memcpy(dst - sizeof(std::size_t), &size, sizeof(std::size_t));
+            std::memcpy(dst, std::data(code), size);
+            __builtin___clear_cache(dst, dst + size);
+            std::atomic_thread_fence(std::memory_order_release);
+            this->used = offset + size;
+            return offset;
+        }
+
+        /**
+         * @brief 读者: 以可执行的只读映射访问 `name` 中位于 `offset` 处的代码.
+         * @tparam F 函数类型, 例如 `int(int)`.
+         * @return 同 `ShM_Reader::read`; 解引用得到函数.
+         * @exception 映射不可执行 (例如 `/dev/shm` 以 `noexec` 挂载) 时, 抛
+         *            `std::system_error` (`std::errc::operation_not_permitted`).
+         * @see Shared_Memory::is_executable
+         */
+        template <class F>
+        static auto load(ShM_Reader<false>& reader, const std::string_view name, const std::size_t offset) {
+            auto code = reader.template read<F>(name, offset);
+            if (!code.arena().is_executable()) [[unlikely]]
+                throw std::system_error{
+                    std::make_error_code(std::errc::operation_not_permitted),
+                    std::format("‘{}’ 的映射不可执行", name)
+                };
+            const auto size = *reader.template read<std::size_t>(name, offset - sizeof(std::size_t));
+            const auto begin = (char *)&*code;
+            __builtin___clear_cache(begin, begin + size);
+            return code;
+        }
+};
+
+
+struct ShM_Metrics_Options {
+    std::size_t counters = {};  ///< 计数器 (只增) 的数量.
+    std::size_t gauges = {};  ///< 仪表 (可任意设置) 的数量.
+    std::size_t processes = 64;  ///< 同时登记的进程数的上限.
+};
+
+
+/**
+ * @brief 跨进程汇总的应用指标的目录, 位于一块有名字的 shared memory 的开头.
+ * @details 每个进程以 `ShM_Metrics` 登记自己的一组指标 (见其文档); 目录中记录它们
+ *          所在的段和偏移量.  汇总者通过 `ShM_Reader` 读取目录, 再读取每个进程的
+ *          指标并求和, 全程不与各进程交互.  进程注销时, 其计数器的值被转入目录中
+ *          的累计值, 因此计数器的总和不会因进程退出而减少; 仪表的值则随之消失.
+ * @note example:
+ * ```
+ * auto directory = ShM_Metrics_Directory::create("/ipcator.metrics", {.counters = 2, .gauges = 1});
+ * {
+ *     // 各个进程:
+ *     auto a = ShM_Metrics{"/ipcator.metrics"}, b = ShM_Metrics{"/ipcator.metrics"};
+ *     a.add(0), a.add(0), b.add(0, 5), b.add(1);
+ *     a.set(0, 10), b.set(0, 20);
+ *     // 汇总者:
+ *     auto rd = ShM_Reader{};
+ *     const auto totals = rd.template read<ShM_Metrics_Directory>("/ipcator.metrics", 0)->collect(rd);
+ *     assert( totals.processes == 2 );
+ *     assert( totals.counters == (std::vector<std::int64_t>{7, 1}) );
+ *     assert( totals.gauges == (std::vector<std::int64_t>{30}) );
+ * }
+ * auto rd = ShM_Reader{};
+ * const auto totals = rd.template read<ShM_Metrics_Directory>("/ipcator.metrics", 0)->collect(rd);
+ * assert( totals.processes == 0 && totals.counters == (std::vector<std::int64_t>{7, 1}) );
+ * ```
+ */
+class ShM_Metrics_Directory {
+        friend class ShM_Metrics;
+
+        struct alignas(cache_line_size) Cell {
+            std::atomic<std::int64_t> value;
+        };
+        struct Registration {
+            // 低 2 位为状态, 其余为登记的次数; 汇总者据此发现读取期间的变化:
+            std::atomic<std::uint64_t> tag;
+            std::array<char, 24> segment;
+            std::size_t offset;
+        };
+        static constexpr auto vacant = std::uint64_t{0}, claimed = std::uint64_t{1}, live = std::uint64_t{2};
+
+        std::size_t num_counters, num_gauges, num_processes;
+        // 开始和完成注销的次数; 汇总者据此发现与它重叠的注销, 见 `collect`:
+        std::atomic<std::uint64_t> retirements_begun{}, retirements_finished{};
+
+        explicit ShM_Metrics_Directory(const ShM_Metrics_Options& options) noexcept
+        : num_counters(options.counters), num_gauges(options.gauges), num_processes(options.processes) {}
+
+        auto retired() const noexcept {  // 已注销的进程的计数器的累计值.
+            return std::span{
+                (Cell *)((char *)this + ceil_to_cache_line_size(sizeof(ShM_Metrics_Directory))), this->num_counters
+            };
+        }
+        auto registrations() const noexcept {
+            return std::span{(Registration *)std::to_address(std::end(this->retired())), this->num_processes};
+        }
+    public:
+        ShM_Metrics_Directory(const ShM_Metrics_Directory&) = delete;
+        ShM_Metrics_Directory& operator=(const ShM_Metrics_Directory&) = delete;
+
+        /**
+         * @brief 创建名为 `name` 的目录.
+         * @return 目录所在的 shared memory; 析构时目录随之删除.
+         */
+        static auto create(std::string name, const ShM_Metrics_Options& options) -> Shared_Memory<true> {
+            const ShM_Metrics_Directory layout{options};  // 只用于计算布局.
+            auto shm = Shared_Memory{
+                std::move(name),
+                std::size_t((char *)std::to_address(std::end(layout.registrations())) - (char *)&layout)
+            };
+            auto& directory = *new(std::data(shm)) ShM_Metrics_Directory{options};
+            std::uninitialized_value_construct(std::begin(directory.retired()), std::end(directory.retired()));
+            std::uninitialized_value_construct(
+                std::begin(directory.registrations()), std::end(directory.registrations())
+            );
+            return shm;
+        }
+
+        struct Totals {
+            std::vector<std::int64_t> counters, gauges;
+            std::size_t processes;  ///< 被汇总的进程数.
+        };
+        /**
+         * @brief 汇总所有已登记的进程的指标.
+         * @param reader 用于读取各进程的指标; 会缓存其映射, 以便下次汇总.
+         * @details 汇总期间若有进程注销, 它的计数器可能既不在累计值中, 也不再被
+         *          登记 (或者两处都有), 因此重新汇总, 直到没有与之重叠的注销.
+         * @note 注销持续不断 (或有进程在注销中途崩溃) 时, 重试 `max_attempts` 次
+         *       之后放弃, 此时计数器的总和可能暂时偏低.
+         */
+        template <auto writable>
+        auto collect(ShM_Reader<writable>& reader) const -> Totals {
+            constexpr auto max_attempts = 100;
+            for (auto attempt = 1; true; ++attempt) {
+                const auto finished = this->retirements_finished.load(std::memory_order_acquire);
+                auto totals = this->collect_once(reader);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (this->retirements_begun.load(std::memory_order_relaxed) == finished || attempt == max_attempts)
+                    return totals;
+                std::this_thread::yield();
+            }
+        }
+    private:
+        template <auto writable>
+        auto collect_once(ShM_Reader<writable>& reader) const -> Totals {
+            Totals totals{
+                .counters = std::vector<std::int64_t>(this->num_counters),
+                .gauges = std::vector<std::int64_t>(this->num_gauges),
+                .processes = 0,
+            };
+            for (auto i = 0uz; i < this->num_counters; ++i)
+                totals.counters[i] = this->retired()[i].value.load(std::memory_order_relaxed);
+
+            std::vector<std::int64_t> values(this->num_counters + this->num_gauges);
+            for (const auto& registration : this->registrations()) {
+                const auto tag = registration.tag.load(std::memory_order_acquire);
+                if ((tag & 3) != live)
+                    continue;
+                const auto segment = registration.segment;
+                const auto offset = registration.offset;
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (registration.tag.load(std::memory_order_relaxed) != tag)
+                    continue;
+                try {
+                    const auto cells = &*reader.template read<Cell>(std::data(segment), offset);
+                    for (auto i = 0uz; i < std::size(values); ++i)
+                        values[i] = cells[i].value.load(std::memory_order_relaxed);
+                } catch (const std::filesystem::filesystem_error&) {
+                    continue;  // 进程已注销, 其段已被删除.
+                }
+                // 读取期间注销了的进程, 其计数器已 (或即将) 计入累计值, `collect` 会重试:
+                if (registration.tag.load(std::memory_order_acquire) != tag)
+                    continue;
+                for (auto i = 0uz; i < this->num_counters; ++i)
+                    totals.counters[i] += values[i];
+                for (auto i = 0uz; i < this->num_gauges; ++i)
+                    totals.gauges[i] += values[this->num_counters + i];
+                ++totals.processes;
+            }
+            return totals;
+        }
+};
+
+
+/**
+ * @brief 一个进程的一组应用指标, 登记在 `ShM_Metrics_Directory` 中.
+ * @details 每个指标独占一个缓存行, 分配自本对象持有的 `ShM_Resource`.  更新指标
+ *          只是一次 relaxed 的原子操作, 没有系统调用, 也不与其它进程竞争缓存行.
+ *          析构时注销, 并将计数器的值转入目录的累计值.
+ * @note 序号在 [0, `counters`) 中的为计数器, 在 [0, `gauges`) 中的为仪表, 两者各自
+ *       编号; 其含义由各进程事先约定.
+ * @warning 异常退出的进程不会注销, 它在目录中的位置不会被回收.
+ * @see ShM_Metrics_Directory
+ */
+class ShM_Metrics {
+        using Cell = ShM_Metrics_Directory::Cell;
+
+        Shared_Memory<false, true> directory_shm;
+        ShM_Resource<std::set> resource;
+        ShM_Metrics_Directory::Registration *registration;
+        Cell *cells;
+
+        auto directory() const noexcept -> ShM_Metrics_Directory& {
+            return *(ShM_Metrics_Directory *)std::data(this->directory_shm);
+        }
+    public:
+        /**
+         * @brief 在名为 `directory` 的目录中登记.
+         * @exception 目录不存在时, 同 `Shared_Memory` 的 accessor 的构造函数;
+         *            目录已满时抛出 `std::bad_alloc`.
+         */
+        explicit ShM_Metrics(std::string directory)
+        : directory_shm{std::move(directory)} {
+            auto& dir = this->directory();
+            const auto num_cells = dir.num_counters + dir.num_gauges;
+            this->cells = (Cell *)this->resource.allocate(std::max(num_cells, 1uz) * sizeof(Cell), alignof(Cell));
+            std::uninitialized_value_construct_n(this->cells, num_cells);
+            const auto& arena = this->resource.find_arena(this->cells);
+
+            for (auto& registration : dir.registrations())
+                if (
+                    auto tag = registration.tag.load(std::memory_order_relaxed);
+                    (tag & 3) == ShM_Metrics_Directory::vacant
+                    && registration.tag.compare_exchange_strong(
+                        tag, (tag & ~3ull) + 4 + ShM_Metrics_Directory::claimed, std::memory_order_acquire
+                    )
+                ) {
+                    assert(std::size(arena.get_name()) < std::size(registration.segment));
+                    registration.segment = {};
+                    std::ranges::copy(arena.get_name(), std::data(registration.segment));
+                    registration.offset = (char *)this->cells - std::data(arena);
+                    registration.tag.store((tag & ~3ull) + 4 + ShM_Metrics_Directory::live, std::memory_order_release);
+                    this->registration = &registration;
+                    return;
+                }
+            throw std::bad_alloc{};
+        }
+        ShM_Metrics(const ShM_Metrics&) = delete;
+        ShM_Metrics& operator=(const ShM_Metrics&) = delete;
+        ~ShM_Metrics() {
+            // 类似 seqlock 的写者: 汇总者若看到了其间的任何修改, 必然也看到了
+            // `retirements_begun` 的递增, 从而重新汇总 (见 `ShM_Metrics_Directory::collect`).
+            auto& dir = this->directory();
+            dir.retirements_begun.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            for (auto i = 0uz; i < dir.num_counters; ++i)
+                dir.retired()[i].value.fetch_add(
+                    this->cells[i].value.load(std::memory_order_relaxed), std::memory_order_relaxed
+                );
+            const auto tag = this->registration->tag.load(std::memory_order_relaxed);
+            this->registration->tag.store(tag - ShM_Metrics_Directory::live, std::memory_order_release);
+            dir.retirements_finished.fetch_add(1, std::memory_order_release);
+        }
+
+        void add(const std::size_t counter, const std::int64_t n = 1) noexcept {
+            assert(counter < this->directory().num_counters);
+            this->cells[counter].value.fetch_add(n, std::memory_order_relaxed);
+        }
+        void set(const std::size_t gauge, const std::int64_t value) noexcept {
+            assert(gauge < this->directory().num_gauges);
+            this->cells[this->directory().num_counters + gauge].value.store(value, std::memory_order_relaxed);
+        }
+        void adjust(const std::size_t gauge, const std::int64_t delta) noexcept {
+            assert(gauge < this->directory().num_gauges);
+            this->cells[this->directory().num_counters + gauge].value.fetch_add(delta, std::memory_order_relaxed);
+        }
+};
+
+
+/**
+ * @brief 位于 shared memory 中的单生产者单消费者 (SPSC) 变长记录环.
+ * @details 每条记录是 4 字节的长度加上内容, 按 8 字节对齐, 且在环中总是连续的
+ *          (放不下时, 用一个绕回标记跳过环尾的剩余空间).  生产者和消费者的位置
+ *          各占一个缓存行, 并各自缓存对方的位置, 只在看似满/空时才读取对方的缓存行.
+ * @note example:
+ * ```
+ * auto allocator = ShM_Resource<std::set>{};
+ * auto& ring = ShM_Byte_Ring::create(allocator, 64);
+ * assert( ring.try_push(std::as_bytes(std::span{"hello"})) );
+ * assert( ring.try_emplace(3, [](std::span<std::byte> record) { std::ranges::fill(record, std::byte{'x'}); }) );
+ * // 其它进程 (消费者需要可写的访问, 以推进读取位置):
+ * const auto& arena = allocator.find_arena(&ring);
+ * auto rd = ShM_Reader<true>{};
+ * auto other = rd.template read<ShM_Byte_Ring>(arena.get_name(), (char *)&ring - std::data(arena));
+ * std::string received;
+ * while (other->pop([&](std::span<const std::byte> record) { received.append((const char *)std::data(record), std::size(record)); }))
+ *     ;
+ * assert( received == "hello\0xxx"sv );
+ * ```
+ */
+class ShM_Byte_Ring {
+        struct alignas(cache_line_size) Producer_Side {
+            std::atomic<std::uint64_t> head;
+            std::uint64_t cached_tail;
+        };
+        struct alignas(cache_line_size) Consumer_Side {
+            std::atomic<std::uint64_t> tail;
+            std::uint64_t cached_head;
+        };
+        static constexpr auto wrap_marker = UINT32_MAX;
+
+        Producer_Side producer{};
+        Consumer_Side consumer{};
+        std::size_t capacity_;
+
+        explicit ShM_Byte_Ring(const std::size_t capacity) noexcept: capacity_(capacity) {
+            assert(std::has_single_bit(capacity) && capacity >= 8);
+        }
+
+        auto data() const noexcept {
+            return (std::byte *)this + ceil_to_cache_line_size(sizeof(ShM_Byte_Ring));
+        }
+        static constexpr auto record_bytes(const std::size_t size) noexcept -> std::size_t {
+            return (sizeof(std::uint32_t) + size + 7) / 8 * 8;
+        }
+    public:
+        ShM_Byte_Ring(const ShM_Byte_Ring&) = delete;
+        ShM_Byte_Ring& operator=(const ShM_Byte_Ring&) = delete;
+
+        /**
+         * @param capacity 环的字节数, 须为 2 的幂.
+         */
+        static auto size_for(const std::size_t capacity) noexcept -> std::size_t {
+            return ceil_to_cache_line_size(sizeof(ShM_Byte_Ring)) + capacity;
+        }
+        /**
+         * @brief 在 `area` (至少 `size_for(capacity)` 字节, 按缓存行对齐) 处构造环.
+         */
+        static auto create(void *const area, const std::size_t capacity) -> ShM_Byte_Ring& {
+            assert(std::uintptr_t(area) % cache_line_size == 0);
+            return *new(area) ShM_Byte_Ring{capacity};
+        }
+        /**
+         * @brief 从共享内存分配器中分配并构造环.
+         */
+        static auto create(IPCator auto& allocator, const std::size_t capacity) -> ShM_Byte_Ring& {
+            return ShM_Byte_Ring::create(allocator.allocate(size_for(capacity), cache_line_size), capacity);
+        }
+
+        auto capacity() const noexcept { return this->capacity_; }
+        auto empty() const noexcept {
+            return this->consumer.tail.load(std::memory_order_relaxed)
+                   == this->producer.head.load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief 生产者: 预留 `size` 字节的记录, 由 `fill` 就地写入其内容, 然后发布.
+         * @return 空间不足时不调用 `fill`, 返回 `false`.
+         */
+        template <class F>
+        auto try_emplace(const std::size_t size, F&& fill)
+        noexcept(noexcept(fill(std::span<std::byte>{}))) -> bool {
+            const auto need = record_bytes(size), mask = this->capacity_ - 1;
+            if (need > this->capacity_)
+                return false;
+            auto head = this->producer.head.load(std::memory_order_relaxed);
+            const auto skip = this->capacity_ - (head & mask) < need ? this->capacity_ - (head & mask) : 0;
+            if (head + skip + need - this->producer.cached_tail > this->capacity_) {
+                this->producer.cached_tail = this->consumer.tail.load(std::memory_order_acquire);
+                if (head + skip + need - this->producer.cached_tail > this->capacity_)
+                    return false;
+            }
+            if (skip) {
+                std::memcpy(this->data() + (head & mask), &wrap_marker, sizeof(std::uint32_t));
+                head += skip;
+            }
+            const auto length = std::uint32_t(size);
+            std::memcpy(this->data() + (head & mask), &length, sizeof(std::uint32_t));
+            fill(std::span{this->data() + (head & mask) + sizeof(std::uint32_t), size});
+            this->producer.head.store(head + need, std::memory_order_release);
+            return true;
+        }
+        auto try_push(const std::span<const std::byte> record) noexcept -> bool {
+            return this->try_emplace(std::size(record), [&](const std::span<std::byte> dst) noexcept {
+                std::ranges::copy(record, std::begin(dst));
+            });
+        }
+
+        /**
+         * @brief 消费者: 以最旧的记录调用 `f`, 然后释放它.
+         * @return 环为空时返回 `false`.
+         */
+        template <class F>
+        auto pop(F&& f) -> bool {
+            auto tail = this->consumer.tail.load(std::memory_order_relaxed);
+            if (
+                tail == this->consumer.cached_head
+                && (this->consumer.cached_head = this->producer.head.load(std::memory_order_acquire)) == tail
+            )
+                return false;
+            const auto mask = this->capacity_ - 1;
+            std::uint32_t length;
+            std::memcpy(&length, this->data() + (tail & mask), sizeof(std::uint32_t));
+            if (length == wrap_marker) {
+                tail += this->capacity_ - (tail & mask);
+                std::memcpy(&length, this->data(), sizeof(std::uint32_t));
+            }
+            std::forward<F>(f)(std::span<const std::byte>{this->data() + (tail & mask) + sizeof(std::uint32_t), length});
+            this->consumer.tail.store(tail + record_bytes(length), std::memory_order_release);
+            return true;
+        }
+};
+
+
+struct ShM_Log_Sink_Options {
+    std::size_t producers = 16;  ///< 同时存在的生产者 (通常每个线程一个) 的数量上限.
+    std::size_t ring_size = 1 << 16;  ///< 每个生产者的记录环的字节数, 须为 2 的幂.
+    std::size_t formats = 1024;  ///< 格式字符串的数量上限.
+    std::size_t format_storage = 1 << 16;  ///< 格式字符串的总字节数上限.
+};
+
+
+/**
+ * @brief 位于 shared memory 中的低延迟日志后端.
+ * @details 热路径上的线程不做格式化, 也不做系统调用: `Producer::log` 只把格式字符串
+ *          的 ID (驻留在 `ShM_Intern_Table` 中) 和参数的二进制值写入该线程独占的
+ *          `ShM_Byte_Ring`.  另一个日志进程通过 `ShM_Reader` 访问同一个 sink, 由
+ *          `drain` 取出记录, 按 `std::format` 的语法格式化, 再自行写入磁盘.  记录
+ *          一经写入就位于 shared memory 中, 即使生产者随后崩溃也不会丢失.
+ * @note 支持的参数类型: `bool`, 字符, 整数, 浮点数, 指针, 以及可转换为
+ *       `std::string_view` 的字符串 (其内容被拷贝).  参数总是按顺序使用, 格式字符串
+ *       中的参数序号被忽略.
+ * @note 环满时记录被丢弃, 并计入 `Producer::dropped`.
+ * @note example:
+ * ```
+ * auto allocator = ShM_Resource<std::set>{};
+ * auto& sink = ShM_Log_Sink::create(allocator, {.producers = 2, .ring_size = 4096});
+ * {
+ *     auto producer = sink.attach();  // 每个线程一个.
+ *     producer.log("order {} filled: {} @ {:.2f}", 42, "AAPL", 189.125);
+ *     producer.log("{{{}}} {:#x}", true, 255u);
+ * }
+ * // 日志进程:
+ * const auto& arena = allocator.find_arena(&sink);
+ * auto rd = ShM_Reader<true>{};
+ * auto other = rd.template read<ShM_Log_Sink>(arena.get_name(), (char *)&sink - std::data(arena));
+ * std::vector<std::string> lines;
+ * other->drain([&](const ShM_Log_Sink::Entry& entry) { lines.push_back(entry.message); });
+ * assert( lines == (std::vector<std::string>{"order 42 filled: AAPL @ 189.12", "{true} 0xff"}) );
+ * ```
+ */
+class ShM_Log_Sink {
+        std::size_t num_producers, ring_size;
+        std::size_t formats_offset, rings_offset;  // 相对于 `this`.
+
+        explicit ShM_Log_Sink(const ShM_Log_Sink_Options& options) noexcept
+        : num_producers(options.producers), ring_size(options.ring_size),
+          formats_offset(
+              ceil_to_cache_line_size(
+                  ceil_to_cache_line_size(sizeof(ShM_Log_Sink)) + options.producers * sizeof(std::atomic<std::uint32_t>)
+              )
+          ),
+          rings_offset(
+              ceil_to_cache_line_size(
+                  this->formats_offset
+                  + ShM_Intern_Table::size_for({.capacity = options.formats, .storage_size = options.format_storage})
+              )
+          ) {}
+
+        auto claims() const noexcept {
+            return std::span{
+                (std::atomic<std::uint32_t> *)((char *)this + ceil_to_cache_line_size(sizeof(ShM_Log_Sink))),
+                this->num_producers
+            };
+        }
+        auto formats() const noexcept -> ShM_Intern_Table& {
+            return *(ShM_Intern_Table *)((char *)this + this->formats_offset);
+        }
+        auto ring(const std::size_t i) const noexcept -> ShM_Byte_Ring& {
+            return *(ShM_Byte_Ring *)(
+                (char *)this + this->rings_offset + i * ShM_Byte_Ring::size_for(this->ring_size)
+            );
+        }
+
+        /* 参数的编码: 1 字节的类型标记, 然后是值.  `out` 为空时只计算长度. */
+        template <class T>
+        static auto encode(const T& arg, std::byte *const out) noexcept -> std::size_t {
+            const auto put = [&](const char tag, const auto value) noexcept {
+                if (out)
+                    *out = std::byte(tag), std::memcpy(out + 1, &value, sizeof(value));
+                return 1 + sizeof(value);
+            };
+            if constexpr (std::same_as<T, bool>)
+                return put('b', arg);
+            else if constexpr (std::same_as<T, char>)
+                return put('c', arg);
+            else if constexpr (std::signed_integral<T>)
+                return put('i', std::int64_t(arg));
+            else if constexpr (std::unsigned_integral<T>)
+                return put('u', std::uint64_t(arg));
+            else if constexpr (std::floating_point<T>)
+                return put('d', double(arg));
+            else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+                const auto str = std::string_view{arg};
+                const auto size = put('s', std::uint32_t(std::size(str)));
+                if (out)
+                    std::memcpy(out + size, std::data(str), std::size(str));
+                return size + std::size(str);
+            } else if constexpr (std::is_pointer_v<T>)
+                return put('p', (const void *)arg);
+            else
+                static_assert(false && sizeof(T), "不支持的日志参数类型");
+        }
+
+        /* 按 `format` 格式化编码过的参数 `args`. */
+        static auto format_record(const std::string_view format, std::span<const std::byte> args) -> std::string {
+            std::string message;
+            const auto format_arg = [&](const std::string& field) {
+                if (std::empty(args))
+                    return message += field;
+                const auto tag = char(args[0]);
+                args = args.subspan(1);
+                const auto take = [&]<class V>(V value) {
+                    std::memcpy(&value, std::data(args), sizeof(V));
+                    args = args.subspan(sizeof(V));
+                    return value;
+                };
+                const auto vformat = [&](const auto value) {
+                    try {
+                        message += std::vformat(field, std::make_format_args(value));
+                    } catch (const std::format_error&) {
+                        message += field;
+                    }
+                    return message;
+                };
+                switch (tag) {
+                    case 'b': return vformat(take(bool{}));
+                    case 'c': return vformat(take(char{}));
+                    case 'i': return vformat(take(std::int64_t{}));
+                    case 'u': return vformat(take(std::uint64_t{}));
+                    case 'd': return vformat(take(double{}));
+                    case 'p': return vformat(take((const void *)nullptr));
+                    case 's': {
+                        const auto size = take(std::uint32_t{});
+                        const auto str = std::string_view{(const char *)std::data(args), size};
+                        args = args.subspan(size);
+                        return vformat(str);
+                    }
+                    default:
+                        args = {};
+                        return message += field;
+                }
+            };
+
+            for (auto i = 0uz; i < std::size(format); )
+                if (
+                    (format[i] == '{' || format[i] == '}')
+                    && i + 1 < std::size(format) && format[i + 1] == format[i]
+                )
+                    message += format[i], i += 2;
+                else if (const auto close = format.find('}', i); format[i] != '{' || close == format.npos)
+                    message += format[i++];
+                else {
+                    auto field = std::string{format.substr(i, close - i + 1)};
+                    field.erase(1, field.find_first_not_of("0123456789", 1) - 1);  // 去掉参数序号.
+                    format_arg(field);
+                    i = close + 1;
+                }
+            return message;
+        }
+    public:
+        ShM_Log_Sink(const ShM_Log_Sink&) = delete;
+        ShM_Log_Sink& operator=(const ShM_Log_Sink&) = delete;
+
+        static auto size_for(const ShM_Log_Sink_Options& options) noexcept -> std::size_t {
+            const ShM_Log_Sink layout{options};  // 只用于计算布局.
+            return layout.rings_offset + options.producers * ShM_Byte_Ring::size_for(options.ring_size);
+        }
+        /**
+         * @brief 在 `area` (至少 `size_for(options)` 字节, 按缓存行对齐) 处构造 sink.
+         */
+        static auto create(void *const area, const ShM_Log_Sink_Options& options) -> ShM_Log_Sink& {
+            assert(std::uintptr_t(area) % cache_line_size == 0);
+            auto& sink = *new(area) ShM_Log_Sink{options};
+            std::uninitialized_value_construct(std::begin(sink.claims()), std::end(sink.claims()));
+            ShM_Intern_Table::create(
+                &sink.formats(), {.capacity = options.formats, .storage_size = options.format_storage}
+            );
+            for (auto i = 0uz; i < options.producers; ++i)
+                ShM_Byte_Ring::create(&sink.ring(i), options.ring_size);
+            return sink;
+        }
+        /**
+         * @brief 从共享内存分配器中分配并构造 sink.
+         */
+        static auto create(IPCator auto& allocator, const ShM_Log_Sink_Options& options) -> ShM_Log_Sink& {
+            return ShM_Log_Sink::create(allocator.allocate(size_for(options), cache_line_size), options);
+        }
+
+        /**
+         * @brief 独占一个记录环的生产者.  析构时归还该环, 其中尚未取出的记录不受影响.
+         */
+        class Producer {
+                friend ShM_Log_Sink;
+                ShM_Log_Sink *sink;
+                std::size_t index;
+                std::size_t dropped_ = 0;
+                // 最近用过的格式字符串 (按地址直接映射), 以免每次都哈希整个字符串:
+                std::array<std::pair<const char *, ShM_Intern_Table::id_type>, 16> recent_formats{};
+                Producer(ShM_Log_Sink& sink, const std::size_t index) noexcept: sink{&sink}, index{index} {}
+
+                auto format_id(const std::string_view format) noexcept -> std::optional<ShM_Intern_Table::id_type> {
+                    auto& [address, id] = this->recent_formats[
+                        std::uintptr_t(std::data(format)) / alignof(std::max_align_t) % std::size(this->recent_formats)
+                    ];
+                    // 同一地址可能先后存放不同的字符串, 因此还要比较内容:
+                    if (address == std::data(format) && this->sink->formats().resolve(id) == format)
+                        return id;
+                    const auto interned = this->sink->formats().intern(format);
+                    if (interned)
+                        address = std::data(format), id = *interned;
+                    return interned;
+                }
+            public:
+                Producer(Producer&& other) noexcept
+                : sink{std::exchange(other.sink, nullptr)}, index{other.index}, dropped_{other.dropped_},
+                  recent_formats{other.recent_formats} {}
+                Producer& operator=(Producer other) noexcept {
+                    std::swap(this->sink, other.sink);
+                    std::swap(this->index, other.index);
+                    std::swap(this->dropped_, other.dropped_);
+                    std::swap(this->recent_formats, other.recent_formats);
+                    return *this;
+                }
+                ~Producer() {
+                    if (this->sink)
+                        this->sink->claims()[this->index].store(0, std::memory_order_release);
+                }
+
+                /**
+                 * @brief 写入一条日志记录.
+                 * @return 环已满或格式字符串表已满时丢弃该记录, 返回 `false`.
+                 */
+                auto log(const std::string_view format, const auto&... args) noexcept -> bool {
+                    const auto id = this->format_id(format);
+                    const auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::system_clock::now().time_since_epoch()
+                    ).count();
+                    const auto size = sizeof(std::int64_t) + sizeof(ShM_Intern_Table::id_type)
+                                      + (0uz + ... + encode(args, nullptr));
+                    if (
+                        id && this->sink->ring(this->index).try_emplace(size, [&](const std::span<std::byte> record) noexcept {
+                            auto out = std::data(record);
+                            std::memcpy(out, &nanoseconds, sizeof(std::int64_t));
+                            std::memcpy(out += sizeof(std::int64_t), &*id, sizeof(ShM_Intern_Table::id_type));
+                            out += sizeof(ShM_Intern_Table::id_type);
+                            ((out += encode(args, out)), ...);
+                        })
+                    )
+                        return true;
+                    ++this->dropped_;
+                    return false;
+                }
+
+                auto dropped() const noexcept { return this->dropped_; }
+        };
+
+        /**
+         * @brief 为调用者 (通常是一个线程) 分配一个记录环.
+         * @exception 所有记录环都已被占用时抛出 `std::bad_alloc`.
+         */
+        auto attach() -> Producer {
+            for (auto i = 0uz; i < this->num_producers; ++i)
+                if (auto expected = 0u; this->claims()[i].compare_exchange_strong(expected, 1, std::memory_order_acquire))
+                    return Producer{*this, i};
+            throw std::bad_alloc{};
+        }
+
+        struct Entry {
+            std::chrono::system_clock::time_point time;
+            std::size_t producer;  ///< 记录环的序号.
+            std::string message;
+        };
+        /**
+         * @brief 日志进程: 取出所有记录环中现有的记录, 格式化后逐条交给 `f`.
+         * @return 取出的记录数.
+         * @note 同一记录环中的记录保持顺序; 不同记录环之间不按时间归并.
+         */
+        template <class F>
+        auto drain(F&& f) -> std::size_t {
+            auto drained = 0uz;
+            for (auto i = 0uz; i < this->num_producers; ++i)
+                while (this->ring(i).pop([&](const std::span<const std::byte> record) {
+                    std::int64_t nanoseconds;
+                    ShM_Intern_Table::id_type id;
+                    std::memcpy(&nanoseconds, std::data(record), sizeof(std::int64_t));
+                    std::memcpy(&id, std::data(record) + sizeof(std::int64_t), sizeof(ShM_Intern_Table::id_type));
+                    f(Entry{
+                        .time = std::chrono::system_clock::time_point{
+                            std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                                std::chrono::nanoseconds{nanoseconds}
+                            )
+                        },
+                        .producer = i,
+                        .message = format_record(
+                            this->formats().resolve(id),
+                            record.subspan(sizeof(std::int64_t) + sizeof(ShM_Intern_Table::id_type))
+                        ),
+                    });
+                }))
+                    ++drained;
+            return drained;
+        }
+};
+
+
+struct ShM_Time_Series_Options {
+    std::size_t series = 1;  ///< 序列 (例如 品种 × 指标) 的数量.
+    std::size_t capacity = 1 << 16;  ///< 每个序列保留的最近的采样数, 须为 2 的幂.
+};
+
+
+/**
+ * @brief 位于 shared memory 中的列式时间序列环: 每个序列保留最近 `capacity` 个采样.
+ * @details 每个序列的时间戳和值分别存放在两个连续的数组中, 窗口上的聚合是对连续
+ *          数组的简单循环 (环绕处至多分为两段), 并以多个累加器展开, 便于编译器向量化.
+ *          单写者追加采样: 先写入槽位, 再以 release 语义递增该序列的计数.  读者不加
+ *          锁: 按计数确定有效的槽位, 读完后再检查计数, 若读过的槽位在此期间被覆盖
+ *          则重读 (seqlock 的模式).
+ * @tparam Value 采样值的算术类型.
+ * @note 同一序列的时间戳须单调不减, 窗口据此二分查找.
+ * @note example:
+ * ```
+ * auto pool = ShM_Pool<false>{};
+ * auto& series = ShM_Time_Series<double>::create(pool, {.series = 2, .capacity = 4});
+ * for (auto t = 0; t < 6; ++t)
+ *     series.append(0, t * 1000, t * 0.5);  // 只保留最近 4 个: t = 2, 3, 4, 5.
+ * // 其它进程:
+ * const auto& arena = pool.upstream_resource()->find_arena(&series);
+ * auto rd = ShM_Reader{};
+ * auto other = rd.template read<ShM_Time_Series<double>>(arena.get_name(), (char *)&series - std::data(arena));
+ * assert( other->size(0) == 4 && other->size(1) == 0 );
+ * assert( other->latest(0)->second == 2.5 );
+ * const auto summary = *other->summarize(0, 2500, 6000);  // t = 3, 4, 5.
+ * assert( summary.count == 3 && summary.sum == 6 && summary.min == 1.5 && summary.max == 2.5 );
+ * assert( other->window(0, 0, 3001).timestamps == (std::vector<std::int64_t>{2000, 3000}) );
+ * assert( !other->summarize(1, 0, 6000) );
+ * assert( !other->summarize(0, 6000, 2500) && std::empty(other->window(0, 6000, 2500).values) );  // 空窗口.
+ * ```
+ */
+template <class Value = double>
+class ShM_Time_Series {
+        static_assert(std::is_arithmetic_v<Value>);
+    public:
+        using timestamp_type = std::int64_t;
+        using sum_type = std::conditional_t<
+            std::is_floating_point_v<Value>, double,
+            std::conditional_t<std::is_signed_v<Value>, std::int64_t, std::uint64_t>
+        >;
+    private:
+        struct alignas(cache_line_size) Counter {
+            std::atomic<std::uint64_t> appended;  // 追加过的采样总数.
+            std::atomic<std::uint64_t> reserved;  // 写者将要写到的位置; 之前 `capacity` 个以外的槽位已失效.
+        };
+        std::size_t num_series, capacity_;
+
+        explicit ShM_Time_Series(const ShM_Time_Series_Options& options) noexcept
+        : num_series(options.series), capacity_(options.capacity) {
+            assert(std::has_single_bit(options.capacity));
+        }
+
+        auto counters() const noexcept {
+            return std::span{
+                (Counter *)((char *)this + ceil_to_cache_line_size(sizeof(ShM_Time_Series))), this->num_series
+            };
+        }
+        auto timestamps(const std::size_t series) const noexcept -> timestamp_type * {
+            const auto column = ceil_to_cache_line_size(this->capacity_ * sizeof(timestamp_type));
+            return (timestamp_type *)((char *)std::to_address(std::end(this->counters())) + series * column);
+        }
+        auto values(const std::size_t series) const noexcept -> Value * {
+            const auto column = ceil_to_cache_line_size(this->capacity_ * sizeof(Value));
+            return (Value *)((char *)this->timestamps(this->num_series) + series * column);
+        }
+
+        /* 对 [`from`, `to`) 中的采样 (总序号) 读取 `f`, 直到读取期间没有被覆盖为止. */
+        template <class F>
+        auto read_consistent(const std::size_t series, F&& f) const {
+            assert(series < this->num_series);
+            const auto& counter = this->counters()[series];
+            while (true) {
+                const auto to = counter.appended.load(std::memory_order_acquire);
+                const auto from = to - std::min<std::uint64_t>(to, this->capacity_);
+                auto result = f(from, to);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (counter.reserved.load(std::memory_order_relaxed) - from <= this->capacity_)
+                    return result;
+            }
+        }
+        /* [`from`, `to`) 中时间戳落在 [`begin`, `end`) 内的采样 (总序号). */
+        auto find_window(
+            const std::size_t series, const std::uint64_t from, const std::uint64_t to,
+            const timestamp_type begin, const timestamp_type end
+        ) const noexcept -> std::pair<std::uint64_t, std::uint64_t> {
+            if (!(begin < end))
+                return {from, from};
+            const auto timestamps = this->timestamps(series);
+            const auto mask = this->capacity_ - 1;
+            const auto first = *std::ranges::partition_point(
+                std::views::iota(from, to), [&](const auto i) { return timestamps[i & mask] < begin; }
+            );
+            // 从 `first` 开始找, 保证 `first <= last`, 即使读到的是正被覆盖的 (无序的) 时间戳:
+            const auto last = *std::ranges::partition_point(
+                std::views::iota(first, to), [&](const auto i) { return timestamps[i & mask] < end; }
+            );
+            return {first, last};
+        }
+        /* 以 (时间戳, 值, 个数) 逐段访问 [`from`, `to`), 环绕处分为两段. */
+        template <class F>
+        void for_each_run(const std::size_t series, const std::uint64_t from, const std::uint64_t to, F&& f) const {
+            const auto mask = this->capacity_ - 1;
+            for (auto i = from; i != to; ) {
+                const auto n = std::min<std::uint64_t>(to - i, this->capacity_ - (i & mask));
+                f(this->timestamps(series) + (i & mask), this->values(series) + (i & mask), std::size_t(n));
+                i += n;
+            }
+        }
+    public:
+        ShM_Time_Series(const ShM_Time_Series&) = delete;
+        ShM_Time_Series& operator=(const ShM_Time_Series&) = delete;
+
+        static auto size_for(const ShM_Time_Series_Options& options) noexcept -> std::size_t {
+            const ShM_Time_Series layout{options};  // 只用于计算布局.
+            return (char *)layout.values(options.series) - (char *)&layout;
+        }
+        /**
+         * @brief 在 `area` (至少 `size_for(options)` 字节, 按缓存行对齐) 处构造.
+         */
+        static auto create(void *const area, const ShM_Time_Series_Options& options) -> ShM_Time_Series& {
+            assert(std::uintptr_t(area) % cache_line_size == 0);
+            auto& time_series = *new(area) ShM_Time_Series{options};
+            std::uninitialized_value_construct(std::begin(time_series.counters()), std::end(time_series.counters()));
+            return time_series;
+        }
+        /**
+         * @brief 从共享内存分配器 (例如 `ShM_Pool`) 中分配并构造.
+         */
+        static auto create(IPCator auto& allocator, const ShM_Time_Series_Options& options) -> ShM_Time_Series& {
+            return ShM_Time_Series::create(allocator.allocate(size_for(options), cache_line_size), options);
+        }
+
+        auto capacity() const noexcept { return this->capacity_; }
+        auto series() const noexcept { return this->num_series; }
+        /**
+         * @brief 序列中现存的采样数.
+         */
+        auto size(const std::size_t series) const noexcept -> std::size_t {
+            assert(series < this->num_series);
+            return std::min<std::uint64_t>(
+                this->counters()[series].appended.load(std::memory_order_acquire), this->capacity_
+            );
+        }
+
+        /**
+         * @brief 写者: 追加一个采样, 必要时覆盖最旧的.
+         */
+        void append(const std::size_t series, const timestamp_type timestamp, const Value value) noexcept {
+            assert(series < this->num_series);
+            auto& counter = this->counters()[series];
+            const auto n = counter.appended.load(std::memory_order_relaxed), mask = this->capacity_ - 1;
+            assert(!n || this->timestamps(series)[(n - 1) & mask] <= timestamp);
+            // 先宣告将要覆盖的槽位, 使正在读它的读者重读:
+            counter.reserved.store(n + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            this->timestamps(series)[n & mask] = timestamp;
+            this->values(series)[n & mask] = value;
+            counter.appended.store(n + 1, std::memory_order_release);
+        }
+
+        /**
+         * @brief 最新的 (时间戳, 值).  序列为空时返回 `std::nullopt`.
+         */
+        auto latest(const std::size_t series) const noexcept -> std::optional<std::pair<timestamp_type, Value>> {
+            return this->read_consistent(series, [&](const std::uint64_t from, const std::uint64_t to) {
+                const auto i = (to - 1) & (this->capacity_ - 1);
+                return from == to
+                       ? std::nullopt
+                       : std::optional{std::pair{this->timestamps(series)[i], this->values(series)[i]}};
+            });
+        }
+
+        struct Window {
+            std::vector<timestamp_type> timestamps;
+            std::vector<Value> values;
+        };
+        /**
+         * @brief 拷贝时间戳在 [`begin`, `end`) 内的采样.
+         */
+        auto window(const std::size_t series, const timestamp_type begin, const timestamp_type end) const -> Window {
+            return this->read_consistent(series, [&](const std::uint64_t from, const std::uint64_t to) {
+                const auto [first, last] = this->find_window(series, from, to, begin, end);
+                Window window;
+                window.timestamps.reserve(last - first), window.values.reserve(last - first);
+                this->for_each_run(series, first, last, [&](const auto timestamps, const auto values, const auto n) {
+                    window.timestamps.insert(std::end(window.timestamps), timestamps, timestamps + n);
+                    window.values.insert(std::end(window.values), values, values + n);
+                });
+                return window;
+            });
+        }
+
+        struct Summary {
+            std::size_t count;
+            sum_type sum;
+            Value min, max;
+            timestamp_type first, last;  ///< 第一个和最后一个采样的时间戳.
+        };
+        /**
+         * @brief 时间戳在 [`begin`, `end`) 内的采样的个数, 和, 最小值, 最大值.
+         * @return 窗口中没有采样时返回 `std::nullopt`.
+         */
+        auto summarize(const std::size_t series, const timestamp_type begin, const timestamp_type end) const noexcept
+        -> std::optional<Summary> {
+            return this->read_consistent(series, [&](const std::uint64_t from, const std::uint64_t to) -> std::optional<Summary> {
+                const auto [first, last] = this->find_window(series, from, to, begin, end);
+                if (first == last)
+                    return std::nullopt;
+                // 多个独立的累加器, 使循环体没有跨迭代的依赖, 可以向量化:
+                constexpr auto lanes = 8uz;
+                std::array<sum_type, lanes> sums{};
+                std::array<Value, lanes> mins, maxs;
+                mins.fill(std::numeric_limits<Value>::max()), maxs.fill(std::numeric_limits<Value>::lowest());
+                this->for_each_run(series, first, last, [&](auto, const Value *const values, const std::size_t n) {
+                    auto i = 0uz;
+                    for (; i + lanes <= n; i += lanes)
+                        for (auto lane = 0uz; lane < lanes; ++lane) {
+                            sums[lane] += values[i + lane];
+                            mins[lane] = std::min(mins[lane], values[i + lane]);
+                            maxs[lane] = std::max(maxs[lane], values[i + lane]);
+                        }
+                    for (; i < n; ++i) {
+                        sums[0] += values[i];
+                        mins[0] = std::min(mins[0], values[i]);
+                        maxs[0] = std::max(maxs[0], values[i]);
+                    }
+                });
+                const auto mask = this->capacity_ - 1;
+                Summary summary{
+                    .count = last - first,
+                    .sum = {},
+                    .min = std::ranges::min(mins),
+                    .max = std::ranges::max(maxs),
+                    .first = this->timestamps(series)[first & mask],
+                    .last = this->timestamps(series)[(last - 1) & mask],
+                };
+                for (const auto sum : sums)
+                    summary.sum += sum;
+                return summary;
+            });
+        }
+};
+
+
+/**
+ * @brief 位于 shared memory 中的基于信用 (credit) 的流控闸门.
+ * @details 消费者发放 credit (单位由双方约定: 字节数或消息数), 生产者在分配并发送
+ *          消息之前取得相应的 credit; 消费者处理完消息后将其归还.  credit 用尽时,
+ *          生产者可以丢弃消息 (`try_acquire`), 也可以阻塞 (`acquire`) 直到消费者
+ *          归还, 归还时通过 futex 唤醒等待者.  因此在途的消息所占的共享内存有一个
+ *          设计上的上限, 而不会在消费者停滞时耗尽 `/dev/shm`.
+ * @note 可以有多个生产者; 发放 credit 的通常是唯一的消费者.
+ * @warning 一次请求的 credit 超过发放总量时, `acquire` 永远不会返回.
+ * @note example:
+ * ```
+ * auto pool = ShM_Pool<false>{};
+ * auto& gate = ShM_Credit_Gate::create(pool, 2);  // 至多 2 条消息在途.
+ * const auto first = gate.try_acquire(1), second = gate.try_acquire(1), third = gate.try_acquire(1);
+ * assert( first && second && !third );  // 消费者停滞时, 生产者可以丢弃消息...
+ * // 消费者进程:
+ * const auto& arena = pool.upstream_resource()->find_arena(&gate);
+ * auto rd = ShM_Reader<true>{};
+ * auto other = rd.template read<ShM_Credit_Gate>(arena.get_name(), (char *)&gate - std::data(arena));
+ * auto consumer = std::thread{[&] { std::this_thread::sleep_for(10ms); other->release(1); }};
+ * gate.acquire(1);  // ...或者阻塞, 直到消费者归还 credit.
+ * consumer.join();
+ * assert( gate.available() == 0 );
+ * assert( !gate.acquire_for(1, 1ms) );
+ * ```
+ */
+class ShM_Credit_Gate {
+        alignas(cache_line_size) std::atomic<std::uint64_t> granted;  // 累计发放的 credit; 由消费者写.
+        std::atomic<std::uint32_t> grants{};  // 每次发放时加 1, 供 futex 等待.
+        std::atomic<std::uint32_t> waiters{};
+        alignas(cache_line_size) std::atomic<std::uint64_t> consumed{};  // 累计取得的 credit; 由生产者写.
+
+        explicit ShM_Credit_Gate(const std::uint64_t credits) noexcept: granted{credits} {}
+    public:
+        ShM_Credit_Gate(const ShM_Credit_Gate&) = delete;
+        ShM_Credit_Gate& operator=(const ShM_Credit_Gate&) = delete;
+
+        static constexpr auto size_for() noexcept { return sizeof(ShM_Credit_Gate); }
+        /**
+         * @brief 在 `area` (至少 `size_for()` 字节, 按缓存行对齐) 处构造闸门.
+         * @param credits 起初发放的 credit.
+         */
+        static auto create(void *const area, const std::uint64_t credits) -> ShM_Credit_Gate& {
+            assert(std::uintptr_t(area) % cache_line_size == 0);
+            return *new(area) ShM_Credit_Gate{credits};
+        }
+        /**
+         * @brief 从共享内存分配器 (例如 `ShM_Pool`) 中分配并构造闸门.
+         */
+        static auto create(IPCator auto& allocator, const std::uint64_t credits) -> ShM_Credit_Gate& {
+            return ShM_Credit_Gate::create(allocator.allocate(size_for(), cache_line_size), credits);
+        }
+
+        /**
+         * @brief 当前可取得的 credit.
+         */
+        auto available() const noexcept -> std::uint64_t {
+            return this->granted.load(std::memory_order_acquire) - this->consumed.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief 生产者: 取得 `n` 个 credit.  不足时不阻塞, 返回 `false`.
+         */
+        auto try_acquire(const std::uint64_t n) noexcept -> bool {
+            for (auto consumed = this->consumed.load(std::memory_order_relaxed); true; )
+                if (this->granted.load(std::memory_order_acquire) - consumed < n)
+                    return false;
+                else if (this->consumed.compare_exchange_weak(consumed, consumed + n, std::memory_order_acquire))
+                    return true;
+        }
+        /**
+         * @brief 生产者: 取得 `n` 个 credit, 不足时至多等待 `timeout`.
+         * @return 超时时返回 `false`.
+         */
+        auto acquire_for(const std::uint64_t n, const std::chrono::nanoseconds timeout) noexcept -> bool {
+            const auto deadline = std::chrono::steady_clock::now() + timeout;
+            while (true) {
+                const auto seen = this->grants.load(std::memory_order_seq_cst);
+                if (this->try_acquire(n))
+                    return true;
+                const auto remaining = deadline - std::chrono::steady_clock::now();
+                if (remaining <= remaining.zero())
+                    return false;
+                this->waiters.fetch_add(1, std::memory_order_seq_cst);
+                futex_wait(this->grants, seen, remaining);
+                this->waiters.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+        /**
+         * @brief 生产者: 取得 `n` 个 credit, 不足时阻塞, 直到消费者归还.
+         */
+        void acquire(const std::uint64_t n) noexcept {
+            while (true) {
+                const auto seen = this->grants.load(std::memory_order_seq_cst);
+                if (this->try_acquire(n))
+                    return;
+                this->waiters.fetch_add(1, std::memory_order_seq_cst);
+                futex_wait(this->grants, seen);
+                this->waiters.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * @brief 消费者: 发放 (归还) `n` 个 credit, 并唤醒等待的生产者.
+         * @note 没有生产者在等待时, 不做系统调用.
+         */
+        void release(const std::uint64_t n) noexcept {
+            this->granted.fetch_add(n, std::memory_order_release);
+            this->grants.fetch_add(1, std::memory_order_seq_cst);
+            if (this->waiters.load(std::memory_order_seq_cst))
+                futex_wake(this->grants);
+        }
+};
+
+
+struct ShM_Lane_Channel_Options {
+    std::size_t lanes = 2;  ///< lane 的数量; 序号越小, 优先级越高.
+    std::size_t lane_size = 1 << 16;  ///< 每个 lane 的记录环的字节数, 须为 2 的幂.
+};
+
+
+/**
+ * @brief 位于 shared memory 中的多 lane 通道: 控制消息不必排在大量数据之后.
+ * @details 每个 lane 是一个 `ShM_Byte_Ring`, 所有 lane 共用一个 futex 通知字:
+ *          消费者在所有 lane 都空时 `wait`, 生产者只在消费者确实睡眠时才做唤醒的
+ *          系统调用.  消费者按严格优先级 (每取一条消息都先检查更高优先级的 lane) 或
+ *          按权重 (每轮从第 i 个 lane 至多取 `weights[i]` 条) 取出消息.  每个 lane
+ *          记录推入, 取出和因满而丢弃的消息数, 供监控队列深度.
+ * @note 每个 lane 只能有一个生产者; 不同 lane 的生产者可以不同.
+ * @note example:
+ * ```
+ * auto pool = ShM_Pool<false>{};
+ * auto& channel = ShM_Lane_Channel::create(pool, {.lanes = 2, .lane_size = 4096});
+ * for (auto i = 0; i < 3; ++i)
+ *     channel.try_push(1, std::as_bytes(std::span{"bulk"}));
+ * channel.try_push(0, std::as_bytes(std::span{"stop"}));
+ * assert( channel.stats(1).depth() == 3 );
+ * // 消费者进程:
+ * const auto& arena = pool.upstream_resource()->find_arena(&channel);
+ * auto rd = ShM_Reader<true>{};
+ * auto other = rd.template read<ShM_Lane_Channel>(arena.get_name(), (char *)&channel - std::data(arena));
+ * assert( other->wait(0s) );
+ * std::vector<std::size_t> order;
+ * other->drain([&](const std::size_t lane, std::span<const std::byte>) { order.push_back(lane); });
+ * assert( order == (std::vector<std::size_t>{0, 1, 1, 1}) );  // 控制消息优先.
+ * assert( channel.stats(1).depth() == 0 && channel.stats(1).popped == 3 );
+ * assert( !other->wait(1ms) );
+ *
+ * for (auto i = 0; i < 2; ++i)
+ *     channel.try_push(0, std::as_bytes(std::span{"ctrl"}));
+ * for (auto i = 0; i < 3; ++i)
+ *     channel.try_push(1, std::as_bytes(std::span{"bulk"}));
+ * order.clear();
+ * const std::size_t weights[]{1, 2};
+ * other->drain([&](const std::size_t lane, std::span<const std::byte>) { order.push_back(lane); }, weights);
+ * assert( order == (std::vector<std::size_t>{0, 1, 1, 0, 1}) );  // 按权重轮转.
+ * ```
+ */
+class ShM_Lane_Channel {
+        struct alignas(cache_line_size) Producer_Counters {
+            std::atomic<std::uint64_t> pushed, dropped;
+        };
+        struct alignas(cache_line_size) Consumer_Counters {
+            std::atomic<std::uint64_t> popped;
+        };
+        struct Lane {
+            Producer_Counters producer;
+            Consumer_Counters consumer;
+        };
+
+        std::size_t num_lanes, lane_size;
+        alignas(cache_line_size) std::atomic<std::uint32_t> signal{};  // futex 通知字.
+        std::atomic<std::uint32_t> sleeping{};  // 消费者是否 (将要) 在 `signal` 上睡眠.
+
+        explicit ShM_Lane_Channel(const ShM_Lane_Channel_Options& options) noexcept
+        : num_lanes(options.lanes), lane_size(options.lane_size) {}
+
+        auto lane(const std::size_t i) const noexcept -> Lane& {
+            assert(i < this->num_lanes);
+            return ((Lane *)((char *)this + sizeof(ShM_Lane_Channel)))[i];
+        }
+        auto ring(const std::size_t i) const noexcept -> ShM_Byte_Ring& {
+            assert(i < this->num_lanes);
+            return *(ShM_Byte_Ring *)(
+                (char *)this + sizeof(ShM_Lane_Channel) + this->num_lanes * sizeof(Lane)
+                + i * ShM_Byte_Ring::size_for(this->lane_size)
+            );
+        }
+        auto all_empty() const noexcept {
+            for (auto i = 0uz; i < this->num_lanes; ++i)
+                if (!this->ring(i).empty())
+                    return false;
+            return true;
+        }
+        template <class F>
+        auto pop(const std::size_t i, F& f) -> bool {
+            if (!this->ring(i).pop([&](const std::span<const std::byte> message) { f(i, message); }))
+                return false;
+            this->lane(i).consumer.popped.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    public:
+        ShM_Lane_Channel(const ShM_Lane_Channel&) = delete;
+        ShM_Lane_Channel& operator=(const ShM_Lane_Channel&) = delete;
+
+        static auto size_for(const ShM_Lane_Channel_Options& options) noexcept -> std::size_t {
+            return sizeof(ShM_Lane_Channel)
+                   + options.lanes * (sizeof(Lane) + ShM_Byte_Ring::size_for(options.lane_size));
+        }
+        /**
+         * @brief 在 `area` (至少 `size_for(options)` 字节, 按缓存行对齐) 处构造通道.
+         */
+        static auto create(void *const area, const ShM_Lane_Channel_Options& options) -> ShM_Lane_Channel& {
+            assert(std::uintptr_t(area) % cache_line_size == 0);
+            auto& channel = *new(area) ShM_Lane_Channel{options};
+            for (auto i = 0uz; i < options.lanes; ++i) {
+                new(&channel.lane(i)) Lane{};
+                ShM_Byte_Ring::create(&channel.ring(i), options.lane_size);
+            }
+            return channel;
+        }
+        /**
+         * @brief 从共享内存分配器 (例如 `ShM_Pool`) 中分配并构造通道.
+         */
+        static auto create(IPCator auto& allocator, const ShM_Lane_Channel_Options& options) -> ShM_Lane_Channel& {
+            return ShM_Lane_Channel::create(allocator.allocate(size_for(options), cache_line_size), options);
+        }
+
+        auto lanes() const noexcept { return this->num_lanes; }
+
+        /**
+         * @brief 生产者: 向 `lane` 推入一条 `size` 字节的消息, 由 `fill` 就地写入.
+         * @return `lane` 已满时丢弃该消息, 返回 `false`.
+         */
+        template <class F>
+        auto try_emplace(const std::size_t lane, const std::size_t size, F&& fill)
+        noexcept(noexcept(fill(std::span<std::byte>{}))) -> bool {
+            auto& counters = this->lane(lane).producer;
+            if (!this->ring(lane).try_emplace(size, std::forward<F>(fill))) {
+                counters.dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            counters.pushed.fetch_add(1, std::memory_order_relaxed);
+            // 与 `wait` 中的屏障配对: 要么消费者看到这条消息, 要么这里看到它在睡眠.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (this->sleeping.load(std::memory_order_relaxed)) {
+                this->signal.fetch_add(1, std::memory_order_relaxed);
+                futex_wake(this->signal, 1);
+            }
+            return true;
+        }
+        auto try_push(const std::size_t lane, const std::span<const std::byte> message) noexcept -> bool {
+            return this->try_emplace(lane, std::size(message), [&](const std::span<std::byte> dst) noexcept {
+                std::ranges::copy(message, std::begin(dst));
+            });
+        }
+
+        /**
+         * @brief 消费者: 等待任一 lane 非空.
+         * @return 超时时返回 `false`.
+         */
+        auto wait(const std::optional<std::chrono::nanoseconds> timeout = std::nullopt) noexcept -> bool {
+            const auto deadline = std::chrono::steady_clock::now() + timeout.value_or(std::chrono::nanoseconds{});
+            while (true) {
+                const auto seen = this->signal.load(std::memory_order_relaxed);
+                this->sleeping.store(1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (!this->all_empty()) {
+                    this->sleeping.store(0, std::memory_order_relaxed);
+                    return true;
+                }
+                const auto remaining = deadline - std::chrono::steady_clock::now();
+                if (timeout && remaining <= remaining.zero()) {
+                    this->sleeping.store(0, std::memory_order_relaxed);
+                    return false;
+                }
+                futex_wait(this->signal, seen, timeout ? std::optional{remaining} : std::nullopt);
+            }
+        }
+
+        /**
+         * @brief 消费者: 取出所有 lane 中现有的消息, 逐条以 (lane, 消息) 调用 `f`.
+         * @param weights 为空时按严格优先级; 否则按权重轮流取出, 第 i 个 lane 每轮
+         *                至多 `weights[i]` 条 (至少 1 条).
+         * @return 取出的消息数.
+         */
+        template <class F>
+        auto drain(F&& f, const std::span<const std::size_t> weights = {}) -> std::size_t {
+            assert(std::empty(weights) || std::size(weights) == this->num_lanes);
+            auto drained = 0uz;
+            if (std::empty(weights))
+                for (auto i = 0uz; i < this->num_lanes; )
+                    if (this->pop(i, f))
+                        ++drained, i = 0;  // 每条消息之后, 都先回到最高优先级的 lane.
+                    else
+                        ++i;
+            else
+                for (auto progress = true; progress; ) {
+                    progress = false;
+                    for (auto i = 0uz; i < this->num_lanes; ++i)
+                        for (auto quota = std::max(weights[i], 1uz); quota && this->pop(i, f); --quota)
+                            ++drained, progress = true;
+                }
+            return drained;
+        }
+
+        struct Lane_Stats {
+            std::uint64_t pushed, popped, dropped;
+            auto depth() const noexcept { return this->pushed - this->popped; }  ///< 尚未取出的消息数.
+        };
+        auto stats(const std::size_t lane) const noexcept -> Lane_Stats {
+            const auto popped = this->lane(lane).consumer.popped.load(std::memory_order_relaxed);
+            // `pushed` 在消息发布之后才递增, 可能暂时落后于 `popped`:
+            return {
+                .pushed = std::max(this->lane(lane).producer.pushed.load(std::memory_order_relaxed), popped),
+                .popped = popped,
+                .dropped = this->lane(lane).producer.dropped.load(std::memory_order_relaxed),
+            };
+        }
 };
 
 
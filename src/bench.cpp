@@ -0,0 +1,67 @@
+#include "ipcator.hpp"
+#include <random>
+
+// 重复执行 ‘f’, 返回平均每次的耗时.
+auto time_it(const auto f, const unsigned repeat = 8) {
+    f();  // 预热.
+    const auto start = std::chrono::steady_clock::now();
+    for (auto _ = repeat; _--; )
+        f();
+    return (std::chrono::steady_clock::now() - start) / repeat;
+}
+
+void bench_publish_copy() {
+    std::cout << "publish_copy vs. memcpy (写入共享内存块):\n";
+    for (const auto size : {64uz << 20, 256uz << 20}) {  // 均远超 LLC 的容量.
+        auto allocator = ShM_Resource<std::unordered_set>{};
+        const auto block = (char *)allocator.allocate(size);
+        std::vector<char> payload(size, 'x');
+
+        const auto by_memcpy = time_it([&] { std::memcpy(block, std::data(payload), size); }),
+                   by_stream = time_it([&] { publish_copy(block, std::data(payload), size); });
+        const auto GiB_per_s = [&](const auto duration) {
+            return size / std::chrono::duration<double>(duration).count() / (1uz << 30);
+        };
+        std::cout << std::format(
+            "\t{:4} MiB:  memcpy {:6.2f} GiB/s,  publish_copy {:6.2f} GiB/s\n",
+            size >> 20, GiB_per_s(by_memcpy), GiB_per_s(by_stream)
+        );
+    }
+}
+
+void bench_sorted_table() {
+    std::cout << "ShM_Sorted_Table vs. std::lower_bound (随机查询):\n";
+    for (const auto size : {1uz << 16, 1uz << 24}) {
+        std::vector<std::int64_t> keys(size);
+        std::ranges::generate(keys, [key = 0l]() mutable { return key += 3; });
+        std::vector<std::pair<std::int64_t, std::int64_t>> entries;
+        for (const auto key : keys)
+            entries.emplace_back(key, -key);
+        const auto shm = ShM_Sorted_Table<std::int64_t>::build(generate_shm_UUName(), entries);
+        auto rd = ShM_Reader{};
+        const auto table = rd.template read<ShM_Sorted_Table<std::int64_t>>(shm.get_name(), 0);
+
+        std::vector<std::int64_t> queries(1 << 22);
+        std::ranges::generate(queries, [rng = std::mt19937_64{}, max = 3 * size]() mutable { return rng() % max; });
+        auto checksum = 0l;
+        const auto by_lower_bound = time_it([&] {
+            for (const auto query : queries)
+                checksum += *std::ranges::lower_bound(keys, query);
+        }), by_table = time_it([&] {
+            for (const auto query : queries)
+                checksum += table->lower_bound(query)->first;
+        });
+        const auto ns_per_query = [&](const auto duration) {
+            return std::chrono::duration<double, std::nano>(duration).count() / std::size(queries);
+        };
+        std::cout << std::format(
+            "\t{:9} 个键:  lower_bound {:6.1f} ns,  ShM_Sorted_Table {:6.1f} ns  (checksum {})\n",
+            size, ns_per_query(by_lower_bound), ns_per_query(by_table), checksum
+        );
+    }
+}
+
+int main() {
+    bench_publish_copy();
+    bench_sorted_table();
+}
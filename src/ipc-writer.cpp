@@ -6,8 +6,7 @@ int main(int, const char *const av[]) {
     auto shm_allocator = Monotonic_ShM_Buffer/* 或 ShM_Pool<false> 或 ShM_Pool<true> */{};
     const auto size_fn = std::stoul([&] { const auto p = popen(("echo print\\(0x`nm -SC "s + av[0] + " | grep ' shared_fn(int)$' - | awk -F' ' '{print $2}'`\\) | python3").c_str(), "r"); char buf[4]; fgets(buf, sizeof buf, p); return std::string{buf}; }());
     const auto block = (char *)shm_allocator.allocate(size_fn);  // 向 buffer 申请内存块.
-    for (const auto i : std::views::iota(0u, size_fn))
-        block[i] = ((char *)shared_fn)[i];  // 向内存块写入数据.
+    publish_copy(block, (char *)shared_fn, size_fn);  // 向内存块写入数据.
 
     // 查找 block 所在的 POSIX shared memory:
     const auto& target_shm = shm_allocator.upstream_resource()->find_arena(block);
@@ -6,6 +6,20 @@ Shared_Memory shm{"/ipcator.example-Shared_Memory-creator", 1234};
 static_assert( std::is_same_v<decltype(shm), Shared_Memory<true, true>> );
 }
 {
+Shared_Memory shm{"/ipcator.Shared_Memory-aligned", 5000, 2uz << 20};
+assert( std::uintptr_t(std::data(shm)) % (2uz << 20) == 0 );
+assert( shm.get_alignment() == 2uz << 20 );
+}
+{
+auto old = Shared_Memory{"/ipcator.adopt", 100};
+old[7] = 7;
+old.persist();
+old = {"/ipcator.adopt-other", 1};  // 析构, 但不 unlink.
+auto adopted = Shared_Memory{std::adopt_lock, "/ipcator.adopt"};
+static_assert( std::is_same_v<decltype(adopted), Shared_Memory<true, true>> );
+assert( adopted[7] == 7 && std::size(adopted) == 100 );
+}
+{
 Shared_Memory creator{"/ipcator.1", 1};
 Shared_Memory accessor{"/ipcator.1"};
 static_assert( std::is_same_v<decltype(accessor), Shared_Memory<false, false>> );
@@ -32,6 +46,13 @@ auto a = Shared_Memory{"/ipcator.name", 1};
 assert( a.get_name() == "/ipcator.name" );
 }
 {
+const auto path = std::filesystem::temp_directory_path() / "ipcator.sync";
+auto file = Shared_Memory{path.native(), 8192};
+file[4096] = 'S';
+file.sync(4096, 1);
+file.sync(0, std::size(file), false);
+}
+{
 auto a = Shared_Memory{"/ipcator.assign-1", 3};
 a = {"/ipcator.assign-2", 5};
 assert(
@@ -58,6 +79,29 @@ auto _ = allocator.allocate(12); _ = allocator.allocate(34, 8);
      _ = allocator.allocate(56), _ = allocator.allocate(78, 16);
 }
 {
+std::string name;
+{
+    auto writer = ShM_Resource<std::set>{{.manifest = "/ipcator.manifest"}};
+    auto area = (char *)writer.allocate(100, 64uz << 10);
+    area[42] = 42;
+    name = writer.find_arena(area).get_name();
+}  // 有序退出: 记入 manifest, 并且不 unlink.
+auto restarted = ShM_Resource<std::unordered_set>{{.manifest = "/ipcator.manifest"}};
+assert( std::size(restarted.get_resources()) == 1 );
+auto& shm = *std::cbegin(restarted.get_resources());
+assert( shm.get_name() == name && shm[42] == 42 );
+assert( std::uintptr_t(std::data(shm)) % (64uz << 10) == 0 );
+restarted.discard_manifest();  // 不再需要持久化了.
+}
+{
+auto allocator = ShM_Resource<std::unordered_set>{};
+auto area = allocator.allocate(100, 2uz << 20);
+assert( std::uintptr_t(area) % (2uz << 20) == 0 );
+assert( std::data(allocator.find_arena(area)) == area );
+allocator.deallocate(area, 100, 2uz << 20);
+assert( std::empty(allocator.get_resources()) );
+}
+{
 auto allocator_1 = ShM_Resource<std::set>{};
 allocator_1.deallocate(
     allocator_1.allocate(111), 111
@@ -107,16 +151,83 @@ std::cout << a << '\n'
           << b << '\n';
 }
 {
+const auto dir = std::filesystem::temp_directory_path() / "ipcator.arena";
+std::filesystem::create_directories(dir);
+{
+    auto allocator = ShM_Resource<std::set>{{.directory = dir}};
+    auto area = (char *)allocator.allocate(100);
+    auto& file = allocator.find_arena(area);
+    assert( file.get_name().starts_with(dir.native() + '/') );
+    area[0] = 'F';
+    file.sync();
+    auto rd = ShM_Reader{};  // 读取方式不变.
+    assert( *rd.template read<char>(file.get_name(), 0) == 'F' );
+}
+std::filesystem::remove_all(dir);
+}
+{
 assert( ceil_to_page_size(0) == 0 );
 std::cout << ceil_to_page_size(1);
 }
 {
+assert( ceil_to_cache_line_size(0) == 0 );
+assert( ceil_to_cache_line_size(1) == cache_line_size );
+}
+{
+auto lock = Spin_Lock{};
+{
+    const std::lock_guard _{lock};
+    assert( !lock.try_lock() );
+}
+assert( lock.try_lock() );
+lock.unlock();
+}
+{
 auto name = generate_shm_UUName();
 assert( name.length() + 1 == 24 );  // 计算时包括 NULL 字符.
 assert( name.front() == '/' );
 std::cout << name << '\n';
 }
 {
+auto buffer = Monotonic_ShM_Buffer{};
+std::vector<char> payload(1 << 20, 'x');
+auto block = (char *)buffer.allocate(std::size(payload));
+publish_copy(block, std::data(payload), std::size(payload));
+assert( std::equal(block, block + std::size(payload), std::cbegin(payload)) );
+}
+{
+const auto path = std::filesystem::temp_directory_path() / "ipcator.table";
+{
+    auto file = Shared_Memory{path.native(), 100'000};
+    std::ranges::fill(file, 'T');
+    file.persist();
+}
+{
+    const auto shm = load_file(path, "/ipcator.table", 4);
+    assert( std::size(shm) == 100'000 );
+    auto rd = ShM_Reader{};  // 其它进程:
+    assert( *rd.template read<char>("/ipcator.table", 99'999) == 'T' );
+}
+std::filesystem::remove(path);
+}
+{
+const auto page = ::getpagesize() + 0uz;
+auto shm = Shared_Memory{"/ipcator.tracked", 16 * page};
+auto backup = Shared_Memory{"/ipcator.backup", std::size(shm)};
+auto tracker = Dirty_Page_Tracker{shm};
+assert( tracker.snapshot(backup) == 16 );  // 第一次: 全部拷贝.
+shm[3 * page] = 'a';
+shm[9 * page + 5] = 'b';
+assert( tracker.dirty_pages() == (std::vector{3uz, 9uz}) );
+assert( tracker.snapshot(backup) == 2 );
+assert( backup[9 * page + 5] == 'b' );
+assert( tracker.dirty_pages().empty() );
+auto local = Dirty_Page_Tracker{shm, true};  // 只有本进程写入, 可用 soft-dirty.
+local.reset();
+shm[5 * page] = 'c';
+assert( local.dirty_pages() == (std::vector{5uz}) );
+}
+{
 using namespace literals;
 auto creator = "/ipcator.1"_shm[123];
 creator[5] = 5;
@@ -136,6 +247,23 @@ assert(
 );  // 新划取的区域一定位于 `upstream_resource()` 最近一次分配的内存块中.
 }
 {
+auto buffer = Monotonic_ShM_Buffer{};
+auto addr = buffer.allocate(1000, 64uz << 10);
+assert( std::uintptr_t(addr) % (64uz << 10) == 0 );
+}
+{
+auto packed = Monotonic_ShM_Buffer{};
+auto _ = packed.allocate(8); _ = packed.allocate(8);
+assert( packed.cache_line_stats().allocations == 2 );
+assert( packed.cache_line_stats().sharing == 2 );
+packed.release();
+assert( packed.cache_line_stats().allocations == 0 );
+auto isolated = Monotonic_ShM_Buffer{1, true};
+auto a = (char *)isolated.allocate(8), b = (char *)isolated.allocate(8);
+assert( b - a >= (std::ptrdiff_t)cache_line_size );
+assert( isolated.cache_line_stats().sharing == 0 );
+}
+{
 auto pools = ShM_Pool<false>{
     std::pmr::pool_options{
         .max_blocks_per_chunk = 0,
@@ -146,6 +274,14 @@ std::cout << pools.options().largest_required_pool_block << ", "
           << pools.options().max_blocks_per_chunk << '\n';
 }
 {
+auto pools = ShM_Pool<true>{{}, true};
+auto a = pools.allocate(4), b = pools.allocate(4);
+assert( pools.cache_line_stats().allocations == 2 );
+assert( pools.cache_line_stats().sharing == 0 );
+pools.deallocate(a, 4), pools.deallocate(b, 4);
+assert( pools.cache_line_stats().allocations == 0 );
+}
+{
 auto pools = ShM_Pool<false>{};
 auto _ = pools.allocate(1);
 assert( std::size(pools.upstream_resource()->get_resources()) );
@@ -173,4 +309,370 @@ auto rd = ShM_Reader{};
 auto arr_from_other_proc = rd.template read<std::array<char, 32>>("/ipcator.1", 42);
 assert( (*arr_from_other_proc)[15] == 9 );
 }
+{
+using namespace literals;
+auto a = "/ipcator.batch-a"_shm[100], b = "/ipcator.batch-b"_shm[100];
+a[0] = 'a', a[1] = 'A', b[0] = 'b';
+auto rd = ShM_Reader{};
+const std::pair<std::string_view, std::size_t> descriptors[] = {
+    {"/ipcator.batch-a", 0}, {"/ipcator.batch-b", 0}, {"/ipcator.batch-a", 1},
+};
+auto batch = rd.template read_batch<char>(descriptors);
+assert( std::size(batch) == 3 );
+assert( batch[0] == 'a' && batch[1] == 'b' && batch[2] == 'A' );
+}
+{
+using namespace literals;
+auto shm = "/ipcator.batch"_shm[4096];
+for (auto i : std::views::iota(0, 8))
+    new(&shm[i * 64]) int{i};
+auto rd = ShM_Reader{};
+std::vector<std::pair<std::string, std::size_t>> descriptors;
+for (auto i : std::views::iota(0uz, 8uz))
+    descriptors.emplace_back("/ipcator.batch", i * 64);
+auto sum = 0;
+for (auto& n : rd.template read_ahead<int>(descriptors, 4, true))
+    sum += n;
+assert( sum == 28 );
+assert( std::ranges::max(rd.template read_ahead<int>(descriptors, 4)) == 7 );  // 可用于标准算法.
+}
+{
+auto allocator = ShM_Resource<std::set>{};
+auto& cache = ShM_LRU_Cache::create(allocator, {.capacity = 4, .max_value_size = 16, .shards = 1});
+assert( cache.put("a", "1") && cache.put("b", "2") );
+assert( cache.get("a") == "1" );
+assert( !cache.put("c", std::string(17, 'x')) );  // 超出 `max_value_size`.
+for (auto key : {"c", "d", "e"})
+    cache.put(key, key);
+assert( cache.stats().size == 4 && cache.stats().evictions == 1 );
+assert( cache.get("a") && !cache.get("b") );  // "a" 最近被访问过, 因此淘汰了 "b".
+// 其它进程:
+const auto& arena = allocator.find_arena(&cache);
+auto rd = ShM_Reader<true>{};
+auto other = rd.template read<ShM_LRU_Cache>(arena.get_name(), (char *)&cache - std::data(arena));
+assert( other->get("e") == "e" );
+assert( other->erase("e") && !cache.get("e") );
+}
+{
+auto allocator = ShM_Resource<std::set>{};
+auto& table = ShM_Intern_Table::create(allocator, {.capacity = 100, .storage_size = 4096});
+const auto id = *table.intern("/usr/lib/libc.so.6");
+assert( table.intern("/usr/lib/libc.so.6") == id );
+assert( table.intern("AAPL") != id );
+assert( table.find("AAPL") && !table.find("MSFT") );
+assert( std::size(table) == 2 );
+const auto too_long = table.intern(std::string(5000, 'x'));  // 超出存储空间.
+assert( !too_long && std::size(table) == 2 );  // 失败的驻留不消耗 ID.
+// 其它进程:
+const auto& arena = allocator.find_arena(&table);
+auto rd = ShM_Reader{};
+auto other = rd.template read<ShM_Intern_Table>(arena.get_name(), (char *)&table - std::data(arena));
+assert( other->resolve(id) == "/usr/lib/libc.so.6" );
+}
+{
+auto pool = ShM_Pool<false>{};
+auto& map = ShM_Slot_Map<std::array<int, 4>>::create(pool, 2);
+const auto a = *map.insert(std::array{1, 2, 3, 4});
+const auto b = *map.insert();
+const auto full = map.insert();
+assert( !full );  // 已满.
+assert( map.get(a)->at(2) == 3 );
+const auto erased = map.erase(b), erased_again = map.erase(b);
+assert( erased && !map.get(b) && !erased_again );
+const auto c = *map.insert();  // 复用 `b` 的 slot, 但代数不同.
+assert( c.index == b.index && c != b && !map.load(b) );
+// 其它进程:
+const auto& arena = pool.upstream_resource()->find_arena(&map);
+auto rd = ShM_Reader{};
+auto other = rd.template read<ShM_Slot_Map<std::array<int, 4>>>(arena.get_name(), (char *)&map - std::data(arena));
+assert( other->load(a)->at(3) == 4 );
+}
+{
+auto heap = ShM_Compacting_Heap{100, 4096};
+std::vector<ShM_Compacting_Heap::Handle> handles;
+for (auto i : std::views::iota(0, 20)) {
+    handles.push_back(heap.allocate(1000));
+    *heap.template get<int>(handles.back()) = i;
+}
+assert( heap.num_segments() == 5 );
+for (auto i = 0; i < 20; i += 2)
+    heap.deallocate(handles[i]);
+assert( heap.num_segments() == 5 && heap.live_bytes() == 10 * 1000 );
+// 其它进程:
+auto rd = ShM_Reader{};
+auto table = rd.template read<ShM_Compacting_Heap::Table>(heap.get_table_name(), 0);
+const auto epoch = table->epoch();
+heap.compact();
+assert( heap.num_segments() == 1 && table->epoch() != epoch );
+assert( **table->template read<int>(rd, handles[3]) == 3 );
+assert( !table->template read<int>(rd, handles[2]) );
+}
+{
+auto allocator = ShM_Resource<std::set>{};
+auto& tree = ShM_BTree<double>::create(allocator, 1000);
+for (auto key : std::views::iota(0, 1000))
+    tree.insert(key * 10, key * .5);
+assert( std::size(tree) == 1000 );
+assert( tree.find(420) == 21. && !tree.find(421) );
+assert( tree.erase(420) && !tree.find(420) );
+// 其它进程:
+const auto& arena = allocator.find_arena(&tree);
+auto rd = ShM_Reader{};
+auto other = rd.template read<ShM_BTree<double>>(arena.get_name(), (char *)&tree - std::data(arena));
+auto sum = 0.;
+other->scan(100, 150, [&](auto, auto value) { sum += value; });
+assert( sum == 5 + 5.5 + 6 + 6.5 + 7 + 7.5 );
+}
+{
+std::vector<std::pair<std::int64_t, char>> entries;
+for (auto c = 'a'; c <= 'z'; ++c)
+    entries.emplace_back(c * 10, c);
+auto shm = ShM_Sorted_Table<char>::build("/ipcator.sorted-table", entries);
+// 其它进程:
+auto rd = ShM_Reader{};
+auto table = rd.template read<ShM_Sorted_Table<char>>("/ipcator.sorted-table", 0);
+assert( std::size(*table) == 26 );
+assert( *table->find('x' * 10) == 'x' && !table->find('x' * 10 + 1) );
+assert( table->lower_bound('x' * 10 + 1)->second == 'y' );
+assert( !table->lower_bound('z' * 10 + 1) );
+}
+{
+auto pool = ShM_Pool<false>{};
+auto& store = ShM_MVCC_Store<int>::create(pool, {.objects = 2, .versions = 4, .readers = 2});
+assert( !store.pin().read(0) );  // 尚未提交.
+store.write(0, 100), store.write(1, 0);
+store.commit();
+// 其它进程:
+const auto& arena = pool.upstream_resource()->find_arena(&store);
+auto rd = ShM_Reader<true>{};
+auto other = rd.template read<ShM_MVCC_Store<int>>(arena.get_name(), (char *)&store - std::data(arena));
+{
+    const auto snapshot = other->pin();
+    store.write(0, 70), store.write(1, 30);  // 一次转账.
+    assert( *snapshot.read(0) + *snapshot.read(1) == 100 );
+    store.commit();
+    assert( *snapshot.read(0) == 100 );  // 快照不变.
+    assert( *other->pin().read(0) == 70 );
+    assert( store.reclaim() == 0 );  // 旧版本仍被快照需要.
+}
+assert( store.reclaim() == 2 );
+}
+{
+auto buffer = Monotonic_ShM_Buffer{};
+auto& log = ShM_Commit_Log::create(buffer, {.records = 4, .blocks = 2});
+const auto header = (std::size_t *)buffer.allocate(sizeof(std::size_t));
+const auto payload = (double *)buffer.allocate(3 * sizeof(double));
+*header = 3, payload[0] = 0.5, payload[1] = 1.5, payload[2] = 2.5;
+log.publish(buffer, {std::as_bytes(std::span{header, 1}), std::as_bytes(std::span{payload, 3})});
+// 其它进程:
+const auto& arena = buffer.upstream_resource()->find_arena(&log);
+auto rd = ShM_Reader{};
+auto other = rd.template read<ShM_Commit_Log>(arena.get_name(), (char *)&log - std::data(arena));
+const auto record = other->latest();
+assert( record && record->sequence == 1 && std::size(record->blocks) == 2 );
+const auto& [segment, offset, size] = record->blocks[1];
+assert( size == 3 * sizeof(double) );
+assert( std::to_address(rd.template read<double>(std::data(segment), offset))[2] == 2.5 );
+for (auto i = 0; i < 4; ++i)
+    log.publish(record->blocks);
+assert( !other->get(1) && other->get(5) && !other->get(6) );  // 最旧的记录已被覆盖.
+}
+{
+auto pool = ShM_Pool<false>{};
+auto& channel = ShM_Delta_Channel::create(pool, {.size = 1 << 20, .capacity = 4096});
+std::vector<char> structure(1 << 20);
+// 其它进程:
+const auto& arena = pool.upstream_resource()->find_arena(&channel);
+auto rd = ShM_Reader{};
+auto other = rd.template read<ShM_Delta_Channel>(arena.get_name(), (char *)&channel - std::data(arena));
+std::vector<char> replica(1 << 20);
+auto position = std::optional<std::uint64_t>{};
+assert( other->sync(replica, position) == std::size(replica) );  // 第一次: 拷贝快照.
+
+structure[42] = 'a', structure[1000] = 'b';
+channel.publish(structure, {{42, 1}, {1000, 1}});
+assert( other->sync(replica, position) == 2 );  // 之后: 只拷贝补丁.
+assert( replica == structure );
+
+for (auto i = 0; i < 1000; ++i)  // 副本落后太多, 补丁已被覆盖:
+    structure[i] = 'c', channel.publish(structure, {{i, 1}});
+assert( other->sync(replica, position) == std::size(replica) && replica == structure );
+std::ranges::fill(structure, 'd');
+channel.publish(structure, {{0, std::size(structure)}});  // 超出补丁环, 整体替换.
+assert( other->sync(replica, position) == std::size(replica) && replica == structure );
+}
+{
+const auto page = ::getpagesize() + 0uz;
+auto shm = Shared_Memory{"/ipcator.delta-tracked", 4 * page};
+const auto source = std::span{shm}.subspan(page / 2, 2 * page);  // 例如池子中的一个对象.
+auto tracker = Dirty_Page_Tracker{shm};
+auto pool = ShM_Pool<false>{};
+auto& channel = ShM_Delta_Channel::create(pool, {.size = std::size(source), .capacity = 4 * page});
+channel.publish(source, tracker);  // 第一次: 所有页面都是脏页.
+std::vector<char> replica(std::size(source));
+auto position = std::optional<std::uint64_t>{};
+const auto copied = channel.sync(replica, position);
+assert( copied == std::size(source) );
+source[page - 1] = 'x';  // 位于 `shm` 的第 1 页, 即 `source` 的 [page/2, 3page/2).
+channel.publish(source, tracker);
+const auto patched = channel.sync(replica, position);
+assert( patched == page && std::ranges::equal(replica, source) );
+}
+#ifdef __x86_64__
+{
+// x86-64 上的 `int twice(int n) { return 2 * n; }`, 即 `lea eax, [rdi + rdi]; ret`:
+constexpr unsigned char twice[]{0x8d, 0x04, 0x3f, 0xc3};
+auto cache = ShM_Code_Cache{"/ipcator.code-cache", 4096};
+const auto offset = cache.add(std::as_bytes(std::span{twice}));
+// 其它进程:
+auto rd = ShM_Reader{};
+const auto fn = ShM_Code_Cache::load<int(int)>(rd, "/ipcator.code-cache", offset);
+assert( (*fn)(21) == 42 );
+}
+#endif
+{
+auto directory = ShM_Metrics_Directory::create("/ipcator.metrics", {.counters = 2, .gauges = 1});
+{
+    // 各个进程:
+    auto a = ShM_Metrics{"/ipcator.metrics"}, b = ShM_Metrics{"/ipcator.metrics"};
+    a.add(0), a.add(0), b.add(0, 5), b.add(1);
+    a.set(0, 10), b.set(0, 20);
+    // 汇总者:
+    auto rd = ShM_Reader{};
+    const auto totals = rd.template read<ShM_Metrics_Directory>("/ipcator.metrics", 0)->collect(rd);
+    assert( totals.processes == 2 );
+    assert( totals.counters == (std::vector<std::int64_t>{7, 1}) );
+    assert( totals.gauges == (std::vector<std::int64_t>{30}) );
+}
+auto rd = ShM_Reader{};
+const auto totals = rd.template read<ShM_Metrics_Directory>("/ipcator.metrics", 0)->collect(rd);
+assert( totals.processes == 0 && totals.counters == (std::vector<std::int64_t>{7, 1}) );
+}
+{
+auto allocator = ShM_Resource<std::set>{};
+auto& ring = ShM_Byte_Ring::create(allocator, 64);
+assert( ring.try_push(std::as_bytes(std::span{"hello"})) );
+assert( ring.try_emplace(3, [](std::span<std::byte> record) { std::ranges::fill(record, std::byte{'x'}); }) );
+// 其它进程 (消费者需要可写的访问, 以推进读取位置):
+const auto& arena = allocator.find_arena(&ring);
+auto rd = ShM_Reader<true>{};
+auto other = rd.template read<ShM_Byte_Ring>(arena.get_name(), (char *)&ring - std::data(arena));
+std::string received;
+while (other->pop([&](std::span<const std::byte> record) { received.append((const char *)std::data(record), std::size(record)); }))
+    ;
+assert( received == "hello\0xxx"sv );
+}
+{
+auto allocator = ShM_Resource<std::set>{};
+auto& sink = ShM_Log_Sink::create(allocator, {.producers = 2, .ring_size = 4096});
+{
+    auto producer = sink.attach();  // 每个线程一个.
+    producer.log("order {} filled: {} @ {:.2f}", 42, "AAPL", 189.125);
+    producer.log("{{{}}} {:#x}", true, 255u);
+}
+// 日志进程:
+const auto& arena = allocator.find_arena(&sink);
+auto rd = ShM_Reader<true>{};
+auto other = rd.template read<ShM_Log_Sink>(arena.get_name(), (char *)&sink - std::data(arena));
+std::vector<std::string> lines;
+other->drain([&](const ShM_Log_Sink::Entry& entry) { lines.push_back(entry.message); });
+assert( lines == (std::vector<std::string>{"order 42 filled: AAPL @ 189.12", "{true} 0xff"}) );
+}
+{
+auto pool = ShM_Pool<false>{};
+auto& series = ShM_Time_Series<double>::create(pool, {.series = 2, .capacity = 4});
+for (auto t = 0; t < 6; ++t)
+    series.append(0, t * 1000, t * 0.5);  // 只保留最近 4 个: t = 2, 3, 4, 5.
+// 其它进程:
+const auto& arena = pool.upstream_resource()->find_arena(&series);
+auto rd = ShM_Reader{};
+auto other = rd.template read<ShM_Time_Series<double>>(arena.get_name(), (char *)&series - std::data(arena));
+assert( other->size(0) == 4 && other->size(1) == 0 );
+assert( other->latest(0)->second == 2.5 );
+const auto summary = *other->summarize(0, 2500, 6000);  // t = 3, 4, 5.
+assert( summary.count == 3 && summary.sum == 6 && summary.min == 1.5 && summary.max == 2.5 );
+assert( other->window(0, 0, 3001).timestamps == (std::vector<std::int64_t>{2000, 3000}) );
+assert( !other->summarize(1, 0, 6000) );
+assert( !other->summarize(0, 6000, 2500) && std::empty(other->window(0, 6000, 2500).values) );  // 空窗口.
+}
+{
+auto pool = ShM_Pool<false>{};
+auto& gate = ShM_Credit_Gate::create(pool, 2);  // 至多 2 条消息在途.
+const auto first = gate.try_acquire(1), second = gate.try_acquire(1), third = gate.try_acquire(1);
+assert( first && second && !third );  // 消费者停滞时, 生产者可以丢弃消息...
+// 消费者进程:
+const auto& arena = pool.upstream_resource()->find_arena(&gate);
+auto rd = ShM_Reader<true>{};
+auto other = rd.template read<ShM_Credit_Gate>(arena.get_name(), (char *)&gate - std::data(arena));
+auto consumer = std::thread{[&] { std::this_thread::sleep_for(10ms); other->release(1); }};
+gate.acquire(1);  // ...或者阻塞, 直到消费者归还 credit.
+consumer.join();
+assert( gate.available() == 0 );
+assert( !gate.acquire_for(1, 1ms) );
+}
+{
+auto pool = ShM_Pool<false>{};
+auto& channel = ShM_Lane_Channel::create(pool, {.lanes = 2, .lane_size = 4096});
+for (auto i = 0; i < 3; ++i)
+    channel.try_push(1, std::as_bytes(std::span{"bulk"}));
+channel.try_push(0, std::as_bytes(std::span{"stop"}));
+assert( channel.stats(1).depth() == 3 );
+// 消费者进程:
+const auto& arena = pool.upstream_resource()->find_arena(&channel);
+auto rd = ShM_Reader<true>{};
+auto other = rd.template read<ShM_Lane_Channel>(arena.get_name(), (char *)&channel - std::data(arena));
+assert( other->wait(0s) );
+std::vector<std::size_t> order;
+other->drain([&](const std::size_t lane, std::span<const std::byte>) { order.push_back(lane); });
+assert( order == (std::vector<std::size_t>{0, 1, 1, 1}) );  // 控制消息优先.
+assert( channel.stats(1).depth() == 0 && channel.stats(1).popped == 3 );
+assert( !other->wait(1ms) );
+
+for (auto i = 0; i < 2; ++i)
+    channel.try_push(0, std::as_bytes(std::span{"ctrl"}));
+for (auto i = 0; i < 3; ++i)
+    channel.try_push(1, std::as_bytes(std::span{"bulk"}));
+order.clear();
+const std::size_t weights[]{1, 2};
+other->drain([&](const std::size_t lane, std::span<const std::byte>) { order.push_back(lane); }, weights);
+assert( order == (std::vector<std::size_t>{0, 1, 1, 0, 1}) );  // 按权重轮转.
+}
+{
+auto creator = std::optional<Shared_Memory<true>>{{"/ipcator.stale", 1}};
+auto accessor = Shared_Memory{"/ipcator.stale"};
+assert( !accessor.is_stale() );
+creator.reset();
+assert( !accessor.is_stale() );
+creator.emplace("/ipcator.stale", 1);
+assert( accessor.is_stale() );
+}
+{
+auto creator = Shared_Memory{"/ipcator.exec", 1};
+assert( !(Shared_Memory<false, true>{"/ipcator.exec"}.is_executable()) );  // W^X.
+}
+{
+auto writer = std::optional<Shared_Memory<true>>{{"/ipcator.reused", 64}};
+(*writer)[0] = 1;
+auto rd = ShM_Reader{1};
+auto old = rd.template read<char>("/ipcator.reused", 0);
+assert( *old == 1 );
+writer.reset();
+writer.emplace("/ipcator.reused", 64);
+(*writer)[0] = 2;
+assert( *rd.template read<char>("/ipcator.reused", 0) == 2 );
+assert( *old == 1 );
+}
+{
+auto writer = std::optional<Shared_Memory<true>>{{"/ipcator.refresh", 8}};
+auto rd = ShM_Reader{};
+(void)rd.template read<char>("/ipcator.refresh", 0);
+auto dropped = rd.refresh();
+assert( dropped == 0 );
+writer.reset();
+writer.emplace("/ipcator.refresh", 8);
+(*writer)[3] = 3;
+dropped = rd.refresh();
+assert( dropped == 1 );
+assert( *rd.template read<char>("/ipcator.refresh", 3) == 3 );
+}
 }